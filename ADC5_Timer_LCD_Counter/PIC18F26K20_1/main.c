@@ -1,30 +1,56 @@
 #include <main.h>
 
+/* ================= ADC scan list ============================
+   AN0..AN4, converted one after another from INT_AD, 10 bits
+   each.  Each reading is smoothed by a 1/4 moving average in
+   the ISR so the hex values on the LCD stop flickering in the
+   last digit, and the values are only reprinted once one of
+   them has moved by more than 8 counts (2 counts at 8 bits).
+   ========================================================= */
+#define ADC_SCAN_COUNT 5
+#define ADC_SCAN_FILTERED
+#define ADC_SCAN_EVENTS
+#define ADC_SCAN_CAPTURE                  // 'c' on the terminal, see main()
+#define ADC_SCAN_PERIOD_US 5060           // Timer2 below
+#include <adcscan.h>
+const unsigned int8 ADC_SCAN_LIST[ADC_SCAN_COUNT] = {0, 1, 2, 3, 4};
+const unsigned int8 ADC_SCAN_FILTER[ADC_SCAN_COUNT] =
+{
+    ADC_FILTER_EMA(2), ADC_FILTER_EMA(2), ADC_FILTER_EMA(2),
+    ADC_FILTER_EMA(2), ADC_FILTER_EMA(2)
+};
+const unsigned int8 ADC_SCAN_DEADBAND[ADC_SCAN_COUNT] = {8, 8, 8, 8, 8};
+#include <adcscan.c>
+
 /* ======================= Globals ===========================
    - counter: increments on button press (RA6)
-   - channel: current ADC channel in round-robin 0..4
-   - values[5]: latest readings for AN0..AN4
+   - scan: AN0..AN4 from one complete scan, with its scan
+     number and start time (Timer1, 1 us)
    ========================================================= */
 unsigned long counter = 0;
-unsigned int  channel  = 0;
-unsigned int  values[5] = {0};   // five channels: AN0..AN4
+ADC_SCAN_SNAP scan;
 
 /* ================= Timer2 ISR ===============================
-   Fires every ~5 ms (per setup below). Each interrupt:
-   1) Stores the last completed ADC result for the current channel
-   2) Advances to the next channel (0..4)
-   3) Starts a new conversion on that next channel
-   This creates a continuous, timer-driven scan of AN0..AN4.
+   Fires every ~5 ms (per setup below) and only starts a scan
+   of AN0..AN4.  The channels themselves are stepped by the
+   ADC interrupt.
    ========================================================= */
 #INT_TIMER2
 void TIMER2_isr(void)
 {
-    values[channel] = read_adc(ADC_READ_ONLY);  // fetch result just finished
-    channel++;
-    if (channel > 4) channel = 0;               // wrap 0..4
-    set_adc_channel(channel);                   // select next channel
-    delay_us(10);                               // acquisition time
-    read_adc(ADC_START_ONLY);                   // start next conversion
+    adc_scan_start();
+}
+
+/* ================= ADC ISR ==================================
+   Fires when a conversion completes.  Stores the result,
+   selects the next channel and starts it; the ADC counts the
+   acquisition time itself (the ADC_TAD_MUL_n adc_setup()
+   works out), so there is no delay in here.
+   ========================================================= */
+#INT_AD
+void AD_isr(void)
+{
+    adc_scan_isr();
 }
 
 /* ================= LCD wiring (4-bit on PORTC/D) ============ */
@@ -35,30 +61,61 @@ void TIMER2_isr(void)
 #define LCD_DATA5      PIN_C5
 #define LCD_DATA6      PIN_C6
 #define LCD_DATA7      PIN_C7
+#define LCD_ROWS       4         // 20x4 module
+#define LCD_SHADOW                // only changed cells reach the LCD
+#define LCD_QUEUE                 // lcd_putc returns at once, Timer0 sends
+#define LCD_INIT_ASYNC            // lcd_init returns at once, Timer0 resets the LCD
+#define LCD_FRAME_HZ   15         // redraw the display 15 times a second
 #include <lcd.c>
+#define OUT_EOL        "\r"       // one line per pass on the UART, as before
+#include <outmux.c>
+
+/* ================= Timer0 ISR ===============================
+   Fires every 128 us and sends one queued nibble to the LCD,
+   so the main loop never waits on the display.  It also times
+   the 15 Hz display frames.
+   ========================================================= */
+#INT_TIMER0
+void TIMER0_isr(void)
+{
+    lcd_task();
+}
 
 void main(void)
 {
-    /* --- ADC: enable AN0..AN4, internal clock --- */
+    unsigned int8 i;
+    int1 moved;
+
+    /* --- ADC: enable AN0..AN4, Fosc/32 = 1 us TAD at 32 MHz,
+           4 TAD acquisition for the 2.45 us a 10K pot needs,
+           counted by the ADC --- */
     setup_adc_ports(sAN0 | sAN1 | sAN2 | sAN3 | sAN4);
-    setup_adc(ADC_CLOCK_INTERNAL | ADC_TAD_MUL_0);
+    adc_setup();
 
     /* --- Timer2: ~5 ms interrupt period --- 
        T2_DIV_BY_16, PR2=252, postscaler=10 ? ~5.06 ms per ISR */
     setup_timer_2(T2_DIV_BY_16, 252, 10);
 
-    /* --- Kick off first conversion on channel 0 --- */
-    set_adc_channel(0);
-    delay_us(10);
-    read_adc(ADC_START_ONLY);
+    /* --- Timer1: free running 1 us clock for the scan time stamps --- */
+    setup_timer_1(T1_INTERNAL | T1_DIV_BY_8);
+
+    /* --- Timer0: 128 us LCD tick (8 MHz / 4 / 256) --- */
+    setup_timer_0(RTCC_INTERNAL | RTCC_DIV_4 | RTCC_8_BIT);
+
+    /* --- Select channel 0, the first scan starts on Timer2 --- */
+    adc_scan_init();
+
+    /* --- LCD init: returns at once, the ~35 ms reset runs from Timer0.
+           Before the interrupts, so the first tick finds the reset
+           state and the queue already set up --- */
+    lcd_init();
 
     /* --- Interrupts on --- */
+    enable_interrupts(INT_AD);
     enable_interrupts(INT_TIMER2);
+    enable_interrupts(INT_TIMER0);
     enable_interrupts(GLOBAL);
 
-    /* --- LCD init --- */
-    lcd_init();
-
     while (TRUE)
     {
         /* Simple edge-hold: increment when RA6 goes high, wait for release */
@@ -68,19 +125,49 @@ void main(void)
             counter++;
         }
 
-        /* --- Display counter --- */
-        lcd_gotoxy(2, 2);
-        printf(lcd_putc, "counter = %4ld ", counter);
+        /* --- 'c' from the terminal captures AN0..AN4 raw for 102
+               scans (~0.5 s) and then sends them in binary, which
+               holds up this loop for ~1.1 s.  The UART is in
+               software, DISABLE_INTS in main.h keeps the ISRs out of
+               each character it reads or sends, so the LCD queue
+               drains slower meanwhile --- */
+        if (kbhit() && (getc() == 'c'))
+            adc_scan_capture(0x1F);
 
-        /* --- Display ADC values (hex for compactness) --- */
-        lcd_gotoxy(21, 1);
-        printf(lcd_putc, "vals %x %x %x ", values[0], values[1], values[2]);
+        if (adc_scan_capture_full())
+            adc_scan_dump();
 
-        lcd_gotoxy(21, 2);
-        printf(lcd_putc, "vals %x %x   ", values[3], values[4]);
+        /* --- Display, once per frame: the rest of the loop keeps
+               polling the button at full speed --- */
+        if (lcd_frame_due())
+        {
+            /* --- Display counter --- */
+            lcd_gotoxy(2, 2);
+            printf(lcd_putc, "counter = %4ld ", counter);
+
+            /* --- ADC values (hex for compactness), all five from the
+                   same scan, formatted once for the LCD and the UART
+                   so both show the same text.  The UART gets both rows
+                   as one "\r" terminated line.  Only when a pot has
+                   moved, so a still board sends nothing to the UART --- */
+            moved = FALSE;
+            for (i = 0; i < ADC_SCAN_COUNT; i++)
+                if (adc_scan_changed(i))
+                    moved = TRUE;
+
+            if (moved)
+            {
+                adc_scan_read(&scan);
 
-        /* --- Stream to UART (optional) --- */
-        printf("values = %x %x %x %x %x\r",
-               values[0], values[1], values[2], values[3], values[4]);
+                out_begin(21, 1);
+                printf(out_putc, "vals %3lx %3lx %3lx ", scan.value[0], scan.value[1], scan.value[2]);
+                out_end(OUT_LCD | OUT_UART_PART);
+
+                out_begin(21, 2);
+                printf(out_putc, "vals %3lx %3lx    ", scan.value[3], scan.value[4]);
+                out_end(OUT_LCD | OUT_UART);
+            }
+            lcd_frame();                    // send only what changed
+        }
     }
 }
@@ -1,5 +1,5 @@
 #include <18F26K20.h>
-#device ADC=8
+#device ADC=10
 
 #FUSES FCMEN                 	//Fail-safe clock monitor enabled
 #FUSES IESO                  	//Internal External Switch Over mode enabled
@@ -24,7 +24,7 @@
 #FUSES NOEBTRB               	//Boot block not protected from table reads
 
 #use delay(internal=32MHz)
-#use rs232(baud=9600,parity=N,xmit=PIN_B0,rcv=PIN_B1,bits=8,stream=PORT1,errors)
+#use rs232(baud=9600,parity=N,xmit=PIN_B0,rcv=PIN_B1,bits=8,stream=PORT1,errors,DISABLE_INTS)
 
 #define LED PIN_B7
 #define DELAY 500
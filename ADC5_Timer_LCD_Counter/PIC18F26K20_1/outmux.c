@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+////                            OUTMUX.C                                   ////
+////           Format a line once, send it to several outputs              ////
+////                                                                       ////
+////  out_begin(x,y)  Start a new line.  x,y is where the LCD copy goes.   ////
+////                                                                       ////
+////  out_putc(c)  Append c to the line, so any printf style formatting    ////
+////              works: printf(out_putc, "adc = %3u", adc),               ////
+////              out_putc("text") or fmt_puts(out_putc, fmt_u8(adc, 3)).  ////
+////              Text past                                                ////
+////              OUT_LINE_SIZE-1 characters (default 20) is dropped.      ////
+////                                                                       ////
+////  out_end(sinks)  Hand the finished line to every sink in the mask:    ////
+////                 OUT_LCD   lcd_gotoxy(x,y) then the line               ////
+////                 OUT_UART  the line then OUT_EOL (default "\n\r") on   ////
+////                           the #use rs232 stream                       ////
+////                 OUT_UART_PART  the line alone, so the next line       ////
+////                           sent to the UART continues it               ////
+////                 OUT_LOG   out_log(line), only if the application      ////
+////                           defines OUT_LOG_SINK and an out_log()       ////
+////                           function before including this file         ////
+////                                                                       ////
+////  The line is formatted once however many sinks get it, so the LCD and ////
+////  the terminal always show the same text.                              ////
+////                                                                       ////
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __OUTMUX_C__
+#define __OUTMUX_C__
+
+#ifndef OUT_LINE_SIZE
+   #define OUT_LINE_SIZE 21            // one 20 character row plus the 0
+#endif
+
+#ifndef OUT_EOL
+   #define OUT_EOL "\n\r"
+#endif
+
+#define OUT_LCD    0x01
+#define OUT_UART   0x02
+#define OUT_LOG    0x04
+#define OUT_UART_PART 0x08
+
+char g_OutLine[OUT_LINE_SIZE];
+unsigned int8 g_OutLen;
+unsigned int8 g_OutX, g_OutY;
+
+void out_begin(unsigned int8 x, unsigned int8 y)
+{
+   g_OutX = x;
+   g_OutY = y;
+   g_OutLen = 0;
+   g_OutLine[0] = 0;
+}
+
+void out_putc(char c)
+{
+   if (g_OutLen < (OUT_LINE_SIZE - 1))
+   {
+      g_OutLine[g_OutLen++] = c;
+      g_OutLine[g_OutLen] = 0;
+   }
+}
+
+void out_end(unsigned int8 sinks)
+{
+   unsigned int8 i;
+
+   if (sinks & OUT_LCD)
+   {
+      lcd_gotoxy(g_OutX, g_OutY);
+      for (i = 0; i < g_OutLen; i++)
+         lcd_putc(g_OutLine[i]);
+   }
+
+   if (sinks & (OUT_UART | OUT_UART_PART))
+   {
+      for (i = 0; i < g_OutLen; i++)
+         putc(g_OutLine[i]);
+      if (sinks & OUT_UART)
+         printf(OUT_EOL);
+   }
+
+  #if defined(OUT_LOG_SINK)
+   if (sinks & OUT_LOG)
+      out_log(g_OutLine);
+  #endif
+}
+
+#endif
@@ -18,8 +18,16 @@
 #define LCD_DATA5      PIN_C5
 #define LCD_DATA6      PIN_C6
 #define LCD_DATA7      PIN_C7
+#define LCD_ROWS       4         // 20x4 module
+#define LCD_SHADOW                // only changed cells reach the LCD
+#define LCD_BUSY_TIMEOUT          // RA4/RA5 buttons still answer with the LCD unplugged
 #include <lcd.c>
 
+/* ---------------- ADC Channels ------------------------ */
+#define ADC_SCAN_COUNT 3          // Pots A, B, C on AN0..AN2
+const unsigned int8 ADC_SCAN_LIST[ADC_SCAN_COUNT] = {0, 1, 2};
+#include <adcscan.c>
+
 /* ---------------- Function Prototypes ---------------- */
 void welcome(void);
 void display_conversion(void);
@@ -27,7 +35,7 @@ void led_display(void);
 void rotates_motor(void);
 
 /* ---------------- Global Variables ------------------- */
-unsigned int value0 = 0, value1 = 0, value2 = 0;  // ADC readings
+unsigned int16 value0 = 0, value1 = 0, value2 = 0;  // ADC readings, 10 bit
 unsigned int counter = 0;                         // Motor control state counter
 
 
@@ -38,7 +46,8 @@ void main()
 {
    // Configure analogue inputs on AN0AN2
    setup_adc_ports(sAN0 | sAN1 | sAN2, VSS_VDD);
-   setup_adc(ADC_CLOCK_INTERNAL | ADC_TAD_MUL_0);
+   adc_setup();
+   adc_scan_init();
 
    lcd_init();   // Initialise LCD display
 
@@ -82,6 +91,7 @@ void welcome(void)
    printf(lcd_putc, "Practical");
    lcd_gotoxy(23,2);
    printf(lcd_putc, "Assessment 22/23");
+   lcd_flush();
 
    while(TRUE);  // Stay on welcome screen
 }
@@ -94,30 +104,23 @@ void welcome(void)
    ============================================================ */
 void display_conversion(void)
 {
-   // Read Potentiometer A (AN0)
-   set_adc_channel(0);
-   delay_us(30);
-   value0 = read_adc();
-
-   // Read Potentiometer B (AN1)
-   set_adc_channel(1);
-   delay_us(30);
-   value1 = read_adc();
-
-   // Read Potentiometer C (AN2)
-   set_adc_channel(2);
-   delay_us(30);
-   value2 = read_adc();
+   // Read Potentiometers A, B and C (AN0..AN2)
+   adc_scan_now();
+   value0 = adc_scan_value(0);
+   value1 = adc_scan_value(1);
+   value2 = adc_scan_value(2);
 
    // Display readings on LCD
    lcd_gotoxy(5, 1);
-   printf(lcd_putc, "Value0 = %3u", value0);
+   printf(lcd_putc, "Value0 = %4lu", value0);
 
    lcd_gotoxy(5, 2);
-   printf(lcd_putc, "Value1 = %3u", value1);
+   printf(lcd_putc, "Value1 = %4lu", value1);
 
    lcd_gotoxy(25, 1);
-   printf(lcd_putc, "Value2 = %3u", value2);
+   printf(lcd_putc, "Value2 = %4lu", value2);
+
+   lcd_flush();   // send only the digits that changed
 }
 
 
@@ -129,31 +132,22 @@ void display_conversion(void)
    ============================================================ */
 void led_display(void)
 {
-   // Read Potentiometer A (AN0)
-   set_adc_channel(0);
-   delay_us(30);
-   value0 = read_adc();
-
-   // Read Potentiometer B (AN1)
-   set_adc_channel(1);
-   delay_us(30);
-   value1 = read_adc();
-
-   // Read Potentiometer C (AN2)
-   set_adc_channel(2);
-   delay_us(30);
-   value2 = read_adc();
-
-   // Display each value in binary on LEDs (PORTB)
-   output_b(value0);       // Pot A ? LEDs
+   // Read Potentiometers A, B and C (AN0..AN2)
+   adc_scan_now();
+   value0 = adc_scan_value(0);
+   value1 = adc_scan_value(1);
+   value2 = adc_scan_value(2);
+
+   // Display the top 8 bits of each value in binary on LEDs (PORTB)
+   output_b(ADC_TO8(value0));   // Pot A ? LEDs
    delay_ms(3000);         // Show for 3 seconds
    output_b(0x00);         // Clear LEDs
 
-   output_b(value1);       // Pot B ? LEDs
+   output_b(ADC_TO8(value1));   // Pot B ? LEDs
    delay_ms(3000);
    output_b(0x00);
 
-   output_b(value2);       // Pot C ? LEDs
+   output_b(ADC_TO8(value2));   // Pot C ? LEDs
    delay_ms(3000);
    output_b(0x00);
 }
@@ -1,5 +1,5 @@
 #include <18F25K22.h>
-#device ADC=8
+#device ADC=10
 
 #FUSES NOWDT                 	//No Watch Dog Timer
 #FUSES PRIMARY               	//Primary clock is system clock when scs=00
@@ -30,13 +30,77 @@
 #define LCD_DATA5      PIN_D5
 #define LCD_DATA6      PIN_D6
 #define LCD_DATA7      PIN_D7
+#define LCD_ROWS       4         // 20x4 module
+#define LCD_INIT_ASYNC            // lcd_init returns at once, Timer0 resets the LCD
+#define LCD_BUSY_TIMEOUT          // SW1 modes keep running if the LCD is pulled
 #include <lcd.c>
+#include <numfmt.c>
+#include <screen.h>
+#include <outmux.c>
+
+/* ---------------- ADC (RV1 on AN0) ----------------
+   Median of the last 3 readings, so a single spike on the pot
+   wiper cannot push the motor past a dead band for one pass */
+#define ADC_SCAN_COUNT        1
+#define ADC_SCAN_FILTERED
+#define ADC_SCAN_MEDIAN_SIZE  2
+#include <adcscan.h>
+const unsigned int8 ADC_SCAN_LIST[ADC_SCAN_COUNT] = {0};
+const unsigned int8 ADC_SCAN_FILTER[ADC_SCAN_COUNT] = {ADC_FILTER_MEDIAN(3)};
+#include <adcscan.c>
+
+/* ---------------- Screen Layout (20x4 LCD) ----------------
+   Values the screens show, set with screen_set() */
+#define VAL_ADC        0     // last ADC reading
+#define VAL_MOTOR      1     // MOTOR_xxx below
+#define VAL_BUTTON     2     // 1 while the button is pressed
+#define SCREEN_VALUES  3
+
+#define MOTOR_ANTICLOCKWISE  0
+#define MOTOR_STOPPED        1
+#define MOTOR_CLOCKWISE      2
+
+// One screen per mode
+#define SCR_MOTOR   0
+#define SCR_LIGHTS  1
+#define SCR_BUTTON  2
+#define SCR_KITT    3
+
+#define TXT_ADC     0        // label
+#define TXT_MOTOR   1        // + VAL_MOTOR
+#define TXT_BUTTON  4        // + VAL_BUTTON
+#define TXT_KITT    6        // label
+
+const char SCREEN_TEXT[7][19] =
+{
+   "adc = ",
+   "Anti-clockwise", "Motor Stopped ", "  Clockwise   ",
+   "Button not pressed", "  Button pressed  ",
+   "Kitt mode"
+};
+
+const SCREEN_FIELD SCREEN_FIELDS[] =
+{
+   // SCR_MOTOR
+   { 6, 1,  6, SCREEN_LABEL,  0,          TXT_ADC    },
+   {12, 1,  4, SCREEN_DEC,    VAL_ADC,    0          },
+   { 4, 2, 14, SCREEN_CHOICE, VAL_MOTOR,  TXT_MOTOR  },
+   // SCR_LIGHTS, the adc line also goes to the terminal so outmux draws it
+   { 6, 1, 10, SCREEN_OWNED,  0,          0          },
+   // SCR_BUTTON
+   { 2, 3, 18, SCREEN_CHOICE, VAL_BUTTON, TXT_BUTTON },
+   // SCR_KITT
+   { 6, 4,  9, SCREEN_LABEL,  0,          TXT_KITT   }
+};
+
+const unsigned int8 SCREEN_START[5] = {0, 3, 4, 5, 6};
+
+#include <screen.c>
 
 /* ---------------- Constants ---------------- */
 #define delay 200    // LED delay time for Knight Rider (ms)
 
 /* ---------------- Function Prototypes ---------------- */
-void analog(void);           // Reads the ADC input
 void run_motor(void);        // Runs motor based on ADC input
 void lcd_lights(void);       // Displays ADC binary output on LEDs
 void button_press(void);     // Runs motor while button pressed
@@ -46,24 +110,43 @@ void kitt_text(void);        // Prints "Kitt mode" once to terminal
 void kitt_mode(void);        // Knight Rider LED light animation
 
 /* ---------------- Global Variables ---------------- */
-unsigned int adc, remainder, new_adc;
+unsigned int16 adc;                  // AN0, 10 bit
+unsigned int remainder, new_adc;
 unsigned int knightrider[14] = 
    {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02};
 static int off = 0, on = 0;   // Track button state changes for terminal output
 
 
+/* =============================================================
+   Function: TIMER0_isr()
+   Purpose:  Fires every 128 us and sends one queued nibble to the
+             LCD, including the power-up reset started by lcd_init().
+   ============================================================= */
+#INT_TIMER0
+void TIMER0_isr(void)
+{
+   lcd_task();
+}
+
+
 /* =============================================================
    Main Program
    ============================================================= */
 void main()
 {
    setup_adc_ports(sAN0);                            // Initialise ADC on AN0
-   setup_adc(ADC_CLOCK_INTERNAL | ADC_TAD_MUL_0);    // Set ADC timing mode
-   lcd_init();                                       // Initialise LCD
+   adc_setup();                                      // ADC clock and acquisition from adcscan.c
+   adc_scan_init();                                  // Select AN0, empty median history
+   setup_timer_0(RTCC_INTERNAL | RTCC_DIV_2 | RTCC_8_BIT);  // 128 us LCD tick (4 MHz / 2 / 256)
+   lcd_init();                                       // Returns at once, the LCD resets in the background
+   enable_interrupts(INT_TIMER0);                    // After lcd_init(), the tick steps the reset it set up
+   enable_interrupts(GLOBAL);
+   screen_set(VAL_MOTOR, MOTOR_STOPPED);             // Motor field reads "Motor Stopped " until run_motor() sets a direction
 
    while(TRUE)
    {
-      analog();   // Continuously read analogue value from RV1
+      adc_scan_now();      // Continuously read analogue value from RV1 (AN0)
+      adc = adc_scan_value(0);   // median of the last 3 readings
       
       // Mode 1: Potentiometer controls motor speed/direction
       if (input(PIN_A2))
@@ -87,18 +170,6 @@ void main()
 }
 
 
-/* =============================================================
-   Function: analog()
-   Purpose:  Reads analogue value from RV1 (AN0)
-   ============================================================= */
-void analog(void)
-{
-   set_adc_channel(0);     // Read ADC channel AN0
-   delay_us(30);           // Allow ADC to settle
-   adc = read_adc();       // Store result in global variable
-}
-
-
 /* =============================================================
    Function: run_motor()
    Purpose:  Controls motor direction/speed based on ADC reading.
@@ -106,35 +177,29 @@ void analog(void)
    ============================================================= */
 void run_motor(void)
 {
-   if (adc < 75)  // ADC < 75 ? Anti-clockwise
+   if (adc < ADC_FROM8(75))  // ADC < 75 ? Anti-clockwise
    {
       output_low(PIN_C0);
       output_high(PIN_C1);
-      lcd_gotoxy(4,2);
-      printf(lcd_putc, "Anti-clockwise");
+      screen_set(VAL_MOTOR, MOTOR_ANTICLOCKWISE);
    }
-   else if ((adc > 76) && (adc < 174))  // Mid-range ? Stop motor
+   else if ((adc > ADC_FROM8_MAX(76)) && (adc < ADC_FROM8(174)))  // Mid-range ? Stop motor
    {
       output_low(PIN_C0);
       output_low(PIN_C1);
-      lcd_gotoxy(4,2);
-      printf(lcd_putc, "Motor Stopped ");
+      screen_set(VAL_MOTOR, MOTOR_STOPPED);
    }
-   else if (adc > 175)  // ADC > 175 ? Clockwise
+   else if (adc > ADC_FROM8_MAX(175))  // ADC > 175 ? Clockwise
    {
       output_high(PIN_C0);
       output_low(PIN_C1);
-      lcd_gotoxy(4,2);
-      printf(lcd_putc, "  Clockwise   ");
+      screen_set(VAL_MOTOR, MOTOR_CLOCKWISE);
    }
 
-   // Display ADC reading on LCD
-   lcd_gotoxy(6,1);
-   printf(lcd_putc, "adc = %3u", adc);
-
-   // Clear unused LCD lines
-   lcd_gotoxy(22,1); printf(lcd_putc, "                  ");
-   lcd_gotoxy(26,2); printf(lcd_putc, "         ");
+   // Display ADC reading and motor state, only changed fields are redrawn
+   screen_set(VAL_ADC, adc);
+   screen_show(SCR_MOTOR);
+   screen_refresh();
 }
 
 
@@ -145,15 +210,16 @@ void run_motor(void)
    ============================================================= */
 void lcd_lights(void)
 {
-   lcd_gotoxy(6,1);
-   printf(lcd_putc, "adc = %3u", adc);
-   lcd_gotoxy(4,2);  printf(lcd_putc, "              ");
-   lcd_gotoxy(22,1); printf(lcd_putc, "                  ");
-   lcd_gotoxy(26,2); printf(lcd_putc, "         ");
-   printf("adc = %3u \n\r", adc);   // Print ADC to terminal
-
-   // Display ADC value on LEDs by converting to binary
-   unsigned int temp = adc;
+   screen_show(SCR_LIGHTS);
+
+   // Format the ADC line once, print it to the LCD and the terminal
+   out_begin(6, 1);
+   out_putc("adc = ");
+   fmt_puts(out_putc, fmt_u16(adc, 4));
+   out_end(OUT_LCD | OUT_UART);
+
+   // Display the top 8 bits of the ADC value on LEDs by converting to binary
+   unsigned int temp = ADC_TO8(adc);
    for (int i = 0; i < 8; i++)
    {
       if (temp % 2)  output_high(PIN_B0 + i);  // Turn ON LED if bit = 1
@@ -174,23 +240,19 @@ void button_press(void)
    {
       output_high(PIN_C0);
       output_low(PIN_C1);
-      lcd_gotoxy(22,1);
-      printf(lcd_putc, "  Button pressed  ");
+      screen_set(VAL_BUTTON, 1);
       button_on();
    }
    else  // Button released
    {
       output_low(PIN_C0);
       output_low(PIN_C1);
-      lcd_gotoxy(22,1);
-      printf(lcd_putc, "Button not pressed");
+      screen_set(VAL_BUTTON, 0);
       button_off();
    }
 
-   // Clear other LCD lines
-   lcd_gotoxy(6,1);  printf(lcd_putc, "         ");
-   lcd_gotoxy(4,2);  printf(lcd_putc, "              ");
-   lcd_gotoxy(26,2); printf(lcd_putc, "         ");
+   screen_show(SCR_BUTTON);
+   screen_refresh();
 }
 
 
@@ -245,11 +307,8 @@ void kitt_text(void)
    ============================================================= */
 void kitt_mode(void)
 {
-   // Clear LCD and display "Kitt mode"
-   lcd_gotoxy(6,1);  printf(lcd_putc, "         ");
-   lcd_gotoxy(4,2);  printf(lcd_putc, "              ");
-   lcd_gotoxy(22,1); printf(lcd_putc, "                  ");
-   lcd_gotoxy(26,2); printf(lcd_putc, "Kitt mode");
+   // Display "Kitt mode", clearing only what the last screen left behind
+   screen_show(SCR_KITT);
 
    // Ensure all LEDs off before animation
    output_b(0x00);
@@ -1,5 +1,5 @@
 #include <18F45K50.h>
-#device ADC=8
+#device ADC=10
 
 #FUSES PRIMARY               	//Primary clock is system clock when scs=00
 #FUSES FCMEN                 	//Fail-safe clock monitor enabled
@@ -35,7 +35,7 @@
 #define LED2	PIN_E1
 #define LED3	PIN_E2
 
-#use rs232(baud=9600, parity=N, xmit=PIN_e0, rcv=PIN_e1, bits=8, stream=PORT1, errors)
+#use rs232(baud=9600, parity=N, xmit=PIN_e0, rcv=PIN_e1, bits=8, stream=PORT1, errors, DISABLE_INTS)
 
 
 #define LED PIN_E2
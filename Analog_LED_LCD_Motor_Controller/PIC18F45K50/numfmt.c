@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////////
+////                            NUMFMT.C                                   ////
+////           Division-free fixed width number rendering                  ////
+////                                                                       ////
+////  fmt_u8(v,w)    Render an 8 bit value, like printf "%3u".             ////
+////  fmt_u16(v,w)   Render a 16 bit value, like printf "%5lu".            ////
+////  fmt_u32(v,w)   Render a 32 bit value, like printf "%10lu".           ////
+////  fmt_hex8(v,w)  Render an 8 bit value in hex, like printf "%2x".      ////
+////  fmt_hex16(v,w) Render a 16 bit value in hex, like printf "%4lx".     ////
+////                                                                       ////
+////  Each renderer right aligns the value in a field of w characters,     ////
+////  padded with spaces, and returns a pointer to the text.  As with      ////
+////  printf a value wider than w is not truncated.  The text lives in one ////
+////  shared buffer, so use it (or copy it) before the next call, and      ////
+////  do not call these from an ISR.                                       ////
+////                                                                       ////
+////  fmt_puts(sink, s)  Send a rendered string to any putc style function,////
+////              for example fmt_puts(lcd_putc, fmt_u8(adc, 3)) or        ////
+////              fmt_puts(putc, fmt_u16(count, 5)) for the rs232 stream.  ////
+////                                                                       ////
+////  Digits are found by subtract-and-count against a table of powers of  ////
+////  ten, so no division or modulo routine is linked in.  Worst case is   ////
+////  9 subtractions per digit: 2+9 for fmt_u8, 4*9 for fmt_u16 and 9*9    ////
+////  32 bit subtractions for fmt_u32.  Hex needs only shifts and masks.   ////
+////                                                                       ////
+////  The printf runtime this replaces, measured off the printf builds in  ////
+////  the tree with tools/ccs_lst/lst_cost.py rom (PCH 5.048, PCM 5.117d): ////
+////     ScaledProduct  @PRINTF_LU 188 + @PRINTF_U 104 + @DIV88 40 +       ////
+////                    @PSTRINGCN 30 = 362 of its 1330 bytes of ROM       ////
+////     MultiIO        the same four, 360 of 1970 bytes                   ////
+////     LCD_ADC_BUTTON @PRINTF_U 53 + @DIV88 21 = 74 of 646 words (PCM)   ////
+////  The numfmt side, and the cycles of either, are not measured: no CCS  ////
+////  build of the numfmt versions exists yet.  Run the same command on    ////
+////  the rebuilt Debug.sym to get its ROM.                                ////
+////                                                                       ////
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NUMFMT_C__
+#define __NUMFMT_C__
+
+#define FMT_MAX_DIGITS 10
+
+const unsigned int16 FMT_POW10_16[4] = {10000, 1000, 100, 10};
+const unsigned int32 FMT_POW10_32[9] = {1000000000, 100000000, 10000000,
+                                        1000000, 100000, 10000, 1000, 100, 10};
+
+char g_FmtBuf[FMT_MAX_DIGITS + 1];
+
+#define fmt_puts(sink, s)   { char *fmt_p = s; while (*fmt_p) sink(*fmt_p++); }
+
+// the digits are written right aligned into g_FmtBuf, with leading zeros
+// already turned into spaces.  trim the field down to width characters
+// without cutting off any digits.
+char *fmt_field(unsigned int8 digits, unsigned int8 width)
+{
+   unsigned int8 start;
+
+   start = FMT_MAX_DIGITS - digits;
+   while ((width < digits) && (g_FmtBuf[start] == ' '))
+   {
+      start++;
+      digits--;
+   }
+   while (width > digits)
+   {
+      if (start == 0)
+         break;
+      g_FmtBuf[--start] = ' ';
+      digits++;
+   }
+   return(&g_FmtBuf[start]);
+}
+
+char *fmt_u8(unsigned int8 v, unsigned int8 width)
+{
+   char d;
+   int1 lead = 1;
+
+   d = '0';
+   while (v >= 100)
+   {
+      v -= 100;
+      d++;
+   }
+   if (d != '0')
+      lead = 0;
+   g_FmtBuf[FMT_MAX_DIGITS - 3] = lead ? ' ' : d;
+
+   d = '0';
+   while (v >= 10)
+   {
+      v -= 10;
+      d++;
+   }
+   if (d != '0')
+      lead = 0;
+   g_FmtBuf[FMT_MAX_DIGITS - 2] = lead ? ' ' : d;
+
+   g_FmtBuf[FMT_MAX_DIGITS - 1] = '0' + v;
+   g_FmtBuf[FMT_MAX_DIGITS] = 0;
+   return(fmt_field(3, width));
+}
+
+char *fmt_u16(unsigned int16 v, unsigned int8 width)
+{
+   unsigned int8 i;
+   char d;
+   int1 lead = 1;
+
+   for (i = 0; i < 4; i++)
+   {
+      d = '0';
+      while (v >= FMT_POW10_16[i])
+      {
+         v -= FMT_POW10_16[i];
+         d++;
+      }
+      if (d != '0')
+         lead = 0;
+      g_FmtBuf[FMT_MAX_DIGITS - 5 + i] = lead ? ' ' : d;
+   }
+   g_FmtBuf[FMT_MAX_DIGITS - 1] = '0' + (unsigned int8)v;
+   g_FmtBuf[FMT_MAX_DIGITS] = 0;
+   return(fmt_field(5, width));
+}
+
+char *fmt_u32(unsigned int32 v, unsigned int8 width)
+{
+   unsigned int8 i;
+   char d;
+   int1 lead = 1;
+
+   for (i = 0; i < 9; i++)
+   {
+      d = '0';
+      while (v >= FMT_POW10_32[i])
+      {
+         v -= FMT_POW10_32[i];
+         d++;
+      }
+      if (d != '0')
+         lead = 0;
+      g_FmtBuf[i] = lead ? ' ' : d;
+   }
+   g_FmtBuf[FMT_MAX_DIGITS - 1] = '0' + (unsigned int8)v;
+   g_FmtBuf[FMT_MAX_DIGITS] = 0;
+   return(fmt_field(10, width));
+}
+
+char fmt_hex_digit(unsigned int8 n)
+{
+   n &= 0x0F;
+   if (n < 10)
+      return('0' + n);
+   return('a' - 10 + n);
+}
+
+char *fmt_hex8(unsigned int8 v, unsigned int8 width)
+{
+   g_FmtBuf[FMT_MAX_DIGITS - 2] = (v < 0x10) ? ' ' : fmt_hex_digit(v >> 4);
+   g_FmtBuf[FMT_MAX_DIGITS - 1] = fmt_hex_digit(v);
+   g_FmtBuf[FMT_MAX_DIGITS] = 0;
+   return(fmt_field(2, width));
+}
+
+char *fmt_hex16(unsigned int16 v, unsigned int8 width)
+{
+   unsigned int8 i;
+   int1 lead = 1;
+
+   for (i = 0; i < 4; i++)
+   {
+      if (make8(v, 1) >= 0x10)
+         lead = 0;
+      g_FmtBuf[FMT_MAX_DIGITS - 4 + i] = (lead && (i < 3)) ? ' ' : fmt_hex_digit(make8(v, 1) >> 4);
+      v <<= 4;
+   }
+   g_FmtBuf[FMT_MAX_DIGITS] = 0;
+   return(fmt_field(4, width));
+}
+
+#endif
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////
+////                            SCREEN.C                                   ////
+////             Table driven screen layouts on top of lcd.c               ////
+////                                                                       ////
+////  See screen.h for how to describe the screens.                        ////
+////                                                                       ////
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __SCREEN_C__
+#define __SCREEN_C__
+
+unsigned int16 g_ScreenValue[SCREEN_VALUES];
+int1 g_ScreenChanged[SCREEN_VALUES];
+unsigned int8 g_Screen = SCREEN_NONE;
+
+// cells of the old screen that the new screen leaves uncovered
+int1 g_ScreenCover[LCD_ROWS * LCD_LINE_LENGTH];
+
+void screen_set(unsigned int8 v, unsigned int16 value)
+{
+   if (g_ScreenValue[v] != value)
+   {
+      g_ScreenValue[v] = value;
+      g_ScreenChanged[v] = 1;
+   }
+}
+
+void screen_draw_field(unsigned int8 f)
+{
+   unsigned int8 i, width, text;
+   unsigned int16 value;
+   char c;
+
+   if (SCREEN_FIELDS[f].format == SCREEN_OWNED)
+      return;
+
+   width = SCREEN_FIELDS[f].width;
+   value = g_ScreenValue[SCREEN_FIELDS[f].value];
+   lcd_gotoxy(SCREEN_FIELDS[f].x, SCREEN_FIELDS[f].y);
+
+   switch (SCREEN_FIELDS[f].format)
+   {
+      case SCREEN_DEC:
+         fmt_puts(lcd_putc, fmt_u16(value, width));
+         break;
+
+      case SCREEN_HEX:
+         fmt_puts(lcd_putc, fmt_hex16(value, width));
+         break;
+
+      default:
+         text = SCREEN_FIELDS[f].text;
+         if (SCREEN_FIELDS[f].format == SCREEN_CHOICE)
+            text += (unsigned int8)value;
+         for (i = 0; i < width; i++)
+         {
+            c = SCREEN_TEXT[text][i];
+            if (!c)
+               break;
+            lcd_putc(c);
+         }
+         for ( ; i < width; i++)
+            lcd_putc(' ');
+         break;
+   }
+}
+
+void screen_cover(unsigned int8 n, int1 on)
+{
+   unsigned int8 f, i, cell;
+
+   for (f = SCREEN_START[n]; f < SCREEN_START[n + 1]; f++)
+   {
+      cell = (SCREEN_FIELDS[f].y - 1) * LCD_LINE_LENGTH + SCREEN_FIELDS[f].x - 1;
+      for (i = 0; i < SCREEN_FIELDS[f].width; i++)
+         g_ScreenCover[cell + i] = on;
+   }
+}
+
+void screen_show(unsigned int8 n)
+{
+   unsigned int8 f, row, col, cell;
+
+   if (n == g_Screen)
+      return;
+
+   // blank what the old screen drew and the new one will not overwrite
+   if (g_Screen != SCREEN_NONE)
+   {
+      for (cell = 0; cell < LCD_ROWS * LCD_LINE_LENGTH; cell++)
+         g_ScreenCover[cell] = 0;
+      screen_cover(g_Screen, 1);
+      screen_cover(n, 0);
+
+      cell = 0;
+      for (row = 1; row <= LCD_ROWS; row++)
+      {
+         for (col = 1; col <= LCD_LINE_LENGTH; col++)
+         {
+            if (g_ScreenCover[cell++])
+            {
+               lcd_gotoxy(col, row);   // no command when already there
+               lcd_putc(' ');
+            }
+         }
+      }
+   }
+
+   g_Screen = n;
+   for (f = SCREEN_START[n]; f < SCREEN_START[n + 1]; f++)
+      screen_draw_field(f);
+   for (f = 0; f < SCREEN_VALUES; f++)
+      g_ScreenChanged[f] = 0;
+}
+
+void screen_refresh(void)
+{
+   unsigned int8 f;
+
+   if (g_Screen == SCREEN_NONE)
+      return;
+
+   for (f = SCREEN_START[g_Screen]; f < SCREEN_START[g_Screen + 1]; f++)
+   {
+      if ((SCREEN_FIELDS[f].format != SCREEN_LABEL) && g_ScreenChanged[SCREEN_FIELDS[f].value])
+         screen_draw_field(f);
+   }
+   for (f = 0; f < SCREEN_VALUES; f++)
+      g_ScreenChanged[f] = 0;
+}
+
+#endif
@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////////
+////                            SCREEN.H                                   ////
+////             Table driven screen layouts on top of lcd.c               ////
+////                                                                       ////
+////  A screen is a list of fields.  Each field owns width cells at x,y    ////
+////  (rows 1-LCD_ROWS, no lcd_gotoxy(21,1) style addresses) and shows     ////
+////  either fixed text or one of SCREEN_VALUES application values.        ////
+////                                                                       ////
+////  Include this file, then define the tables below, then include        ////
+////  screen.c (which also needs lcd.c and numfmt.c):                      ////
+////                                                                       ////
+////     #define SCREEN_VALUES n        number of values fields can show   ////
+////     const SCREEN_FIELD SCREEN_FIELDS[] = { ... };                     ////
+////                                    every screen's fields, screen by   ////
+////                                    screen                             ////
+////     const unsigned int8 SCREEN_START[] = { ... };                     ////
+////                                    index of each screen's first field,////
+////                                    plus one entry past the last field ////
+////     const char SCREEN_TEXT[][n] = { ... };                            ////
+////                                    text for SCREEN_LABEL and          ////
+////                                    SCREEN_CHOICE fields               ////
+////                                                                       ////
+////  screen_set(v, value)  Set value v (16 bits, so a 10 bit ADC reading  ////
+////              fits), fields showing it are marked for the next refresh ////
+////              if it changed.                                           ////
+////  screen_show(n)   Switch to screen n.  Only cells used by the old     ////
+////              screen and not by the new one are blanked.  Calling it   ////
+////              for the screen already shown does nothing.               ////
+////  screen_refresh() Redraw the fields of the current screen whose value ////
+////              changed since the last refresh.                          ////
+////                                                                       ////
+////  SCREEN_OWNED fields are never drawn here.  They only reserve their   ////
+////  cells, so switching screens blanks them like any other field.        ////
+////                                                                       ////
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __SCREEN_H__
+#define __SCREEN_H__
+
+typedef struct
+{
+   unsigned int8 x, y;        // first cell, upper left is 1,1
+   unsigned int8 width;       // cells owned by the field
+   unsigned int8 format;      // SCREEN_xxx below
+   unsigned int8 value;       // value shown, unused for SCREEN_LABEL
+   unsigned int8 text;        // SCREEN_TEXT entry for LABEL and CHOICE
+} SCREEN_FIELD;
+
+#define SCREEN_LABEL    0     // SCREEN_TEXT[text]
+#define SCREEN_DEC      1     // value in decimal, right aligned
+#define SCREEN_HEX      2     // value in hex, right aligned
+#define SCREEN_CHOICE   3     // SCREEN_TEXT[text + value]
+#define SCREEN_OWNED    4     // drawn by the application, e.g. through outmux.c
+
+#define SCREEN_NONE     0xFF
+
+#endif
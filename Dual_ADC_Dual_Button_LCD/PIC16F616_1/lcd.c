@@ -0,0 +1,1715 @@
+///////////////////////////////////////////////////////////////////////////////
+////                             LCD.C                                     ////
+////                 Driver for common LCD modules                         ////
+////                                                                       ////
+////  lcd_init()   Must be called before any other function.               ////
+////                                                                       ////
+////  lcd_putc(c)  Will display c on the next position of the LCD.         ////
+////                 \a  Set cursor position to upper left                 ////
+////                 \f  Clear display, set cursor to upper left           ////
+////                 \n  Go to start of second line                        ////
+////                 \b  Move back one position                            ////
+////              If LCD_EXTENDED_NEWLINE is defined, the \n character     ////
+////              will erase all remanining characters on the current      ////
+////              line, and move the cursor to the beginning of the next   ////
+////              line.                                                    ////
+////              If LCD_EXTENDED_NEWLINE is defined, the \r character     ////
+////              will move the cursor to the start of the current         ////
+////              line.                                                    ////
+////                                                                       ////
+////  lcd_gotoxy(x,y) Set write position on LCD (upper left is 1,1)        ////
+////              Rows 1-LCD_ROWS use LCD_LINE_TWO, LCD_LINE_THREE and     ////
+////              LCD_LINE_FOUR.  The cursor is tracked in software, so no ////
+////              command is sent if the LCD is already at x,y.  LCD_ROWS  ////
+////              is 2 unless the application sets it (4 for 20x4          ////
+////              modules).  With LCD_WRAP defined lcd_putc() wraps from   ////
+////              the end of one row to the start of the next, otherwise   ////
+////              it carries on in DDRAM order as the controller does.     ////
+////                                                                       ////
+////  lcd_getc(x,y)   Returns character at position x,y on LCD             ////
+////                                                                       ////
+////  lcd_cursor_on(int1 on)   Turn the cursor on (on=TRUE) or off         ////
+////              (on=FALSE).                                              ////
+////                                                                       ////
+////  lcd_set_cgram_char(w, *p)   Write a custom character to the CGRAM.   ////
+////              With LCD_CGRAM_CACHE defined the glyph is only sent if   ////
+////              slot w does not already hold it.                         ////
+////                                                                       ////
+////  lcd_bar(x,y,w,level,*last)  Only when LCD_BARGRAPH is defined.  Draws////
+////              a w cell horizontal bar at x,y, level 0-255 is full      ////
+////              scale.  *last remembers what was drawn so only the one   ////
+////              or two cells that change are rewritten.                  ////
+////                                                                       ////
+////  lcd_marquee(y,*text)  Only when LCD_MARQUEE is defined.  Scroll text ////
+////              (in RAM, left in place while it scrolls) along row y.    ////
+////              lcd_marquee_stop(y) leaves the row still again.          ////
+////                                                                       ////
+////  lcd_marquee_step()  Move every scrolling row one character left.     ////
+////                                                                       ////
+////  lcd_flush()  Only when LCD_SHADOW is defined.  Sends every cell that ////
+////              changed since the last flush to the LCD.                 ////
+////                                                                       ////
+////  lcd_task()   Only when LCD_QUEUE is defined.  Call from a periodic   ////
+////              timer ISR, sends the next queued nibble to the LCD.      ////
+////                                                                       ////
+////  lcd_fault()  Only when LCD_BUSY_TIMEOUT is defined.  TRUE while the  ////
+////              LCD is not answering and writes are timed instead.       ////
+////                                                                       ////
+////  lcd_idle()   Only when LCD_QUEUE is defined.  Returns TRUE once every////
+////              queued byte has reached the LCD.                         ////
+////                                                                       ////
+////  lcd_frame()  Only when LCD_FRAME_HZ is defined.  Flushes the shadow  ////
+////              if a frame period has passed since the last flush, and   ////
+////              returns TRUE if it did.  lcd_frame_due() tells whether   ////
+////              it would, so a loop can skip rendering until then.       ////
+////                                                                       ////
+////                                                                       ////
+////  CONFIGURATION                                                        ////
+////  The LCD can be configured in one of two ways: a.) port access or     ////
+////  b.) pin access.  Port access requires the entire 7 bit interface     ////
+////  connected to one GPIO port, and the data bits (D4:D7 of the LCD)     ////
+////  connected to sequential pins on the GPIO.  Pin access                ////
+////  has no requirements, all 7 bits of the control interface can         ////
+////  can be connected to any GPIO using several ports.                    ////
+////                                                                       ////
+////  To use port access, #define LCD_DATA_PORT to the SFR location of     ////
+////  of the GPIO port that holds the interface, -AND- edit LCD_PIN_MAP    ////
+////  of this file to configure the pin order.  If you are using a         ////
+////  baseline PIC (PCB), then LCD_OUTPUT_MAP and LCD_INPUT_MAP also must  ////
+////  be defined.                                                          ////
+////                                                                       ////
+////  Example of port access:                                              ////
+////     #define LCD_DATA_PORT getenv("SFR:PORTD")                         ////
+////                                                                       ////
+////  To use pin access, the following pins must be defined:               ////
+////     LCD_ENABLE_PIN                                                    ////
+////     LCD_RS_PIN                                                        ////
+////     LCD_RW_PIN                                                        ////
+////     LCD_DATA4                                                         ////
+////     LCD_DATA5                                                         ////
+////     LCD_DATA6                                                         ////
+////     LCD_DATA7                                                         ////
+////                                                                       ////
+////  Example of pin access:                                               ////
+////     #define LCD_ENABLE_PIN  PIN_E0                                    ////
+////     #define LCD_RS_PIN      PIN_E1                                    ////
+////     #define LCD_RW_PIN      PIN_E2                                    ////
+////     #define LCD_DATA4       PIN_D4                                    ////
+////     #define LCD_DATA5       PIN_D5                                    ////
+////     #define LCD_DATA6       PIN_D6                                    ////
+////     #define LCD_DATA7       PIN_D7                                    ////
+////                                                                       ////
+////  With pin access, if LCD_DATA4-LCD_DATA7 are four consecutive pins of ////
+////  one port (e.g. PIN_D4-PIN_D7) this is detected at compile time and   ////
+////  each nibble is written with one masked LAT write and read with one   ////
+////  PORT read, instead of four output_bit()/input() calls.  Any other    ////
+////  wiring uses the per-pin code.                                        ////
+////  The masked write reads the whole LAT register and writes it back, so ////
+////  no ISR may write the other pins of that port: a change made between  ////
+////  the read and the write would be undone.  If an ISR has to drive them,////
+////  move them or the LCD to another port.                                ////
+////                                                                       ////
+////  If all of LCD_DATA0-LCD_DATA7 are defined the LCD is run with an 8   ////
+////  bit bus: one enable strobe and one busy read per byte instead of two.////
+////  If they are the eight bits of one port in order (e.g. PIN_D0-PIN_D7) ////
+////  each byte is a single LAT write.  8 bit mode needs pin access.       ////
+////                                                                       ////
+////  What 8 bit mode saves, from the baseline ADC5 Debug.lst (4 bit, per  ////
+////  pin, tools/ccs_lst/lst_cost.py cycles, delay loops added by hand):   ////
+////     lcd_send_nibble  39-46 cycles including its 2 us enable pulse     ////
+////     lcd_read_nibble  42 cycles                                        ////
+////     one data byte    105-120 cycles after the busy check, plus        ////
+////                      121-140 for one busy poll, 28-33 us at 8 MIPS    ////
+////  8 bit mode drops one send and one read nibble per byte.  Its own     ////
+////  cycles are not measured: there is no CCS build of it yet.            ////
+////                                                                       ////
+////  Instead of GPIO pins the LCD can sit behind a serial backpack, with  ////
+////  the expander outputs wired RS, RW, E, backlight, D4, D5, D6, D7 from ////
+////  bit 0 up (the usual module wiring, LCD_SERIAL_RS etc. to change it). ////
+////     LCD_PCF8574      I2C expander, LCD_PCF8574_ADDR is the write      ////
+////                      address (default 0x4E).  #use i2c() must come    ////
+////                      before lcd.c.                                    ////
+////     LCD_74HC595      SPI shift register, LCD_595_LATCH_PIN is RCLK.   ////
+////                      The MSSP must be set up with setup_spi() or      ////
+////                      #use spi() before lcd_init().                    ////
+////  Either one implies LCD_WRITE_ONLY.  Each byte goes out as one burst  ////
+////  of four expander states (high nibble with E high, E low, low nibble  ////
+////  with E high, E low): one I2C transaction of five bytes, or four SPI  ////
+////  bytes each followed by a latch pulse.                                ////
+////  The I2C burst is 45 bit times, 450us at 100kHz, so LCD_PCF8574       ////
+////  cannot be used with LCD_QUEUE (nor LCD_INIT_ASYNC or LCD_FRAME_HZ,   ////
+////  which imply it): lcd_task() would run it from the tick ISR, several  ////
+////  times longer than a 128us tick.  The 74HC595 burst is about 20us at  ////
+////  a 2MHz SPI clock and can be queued.                                  ////
+////                                                                       ////
+////  If LCD_SHADOW is defined a RAM copy of the LCD's DDRAM (80 bytes     ////
+////  plus 10 bytes of dirty flags) is kept.  lcd_putc() and lcd_gotoxy()  ////
+////  then only write the RAM copy, and nothing reaches the display until  ////
+////  lcd_flush() is called.  lcd_flush() sends only the cells that have   ////
+////  changed, with one set-address command per run of adjacent changed    ////
+////  cells, so re-printing an unchanged field costs no LCD time at all.   ////
+////  The shadow assumes the standard 2 line DDRAM map (0x00-0x27 and      ////
+////  0x40-0x67), which also covers 16x2, 20x2 and 20x4 modules.           ////
+////                                                                       ////
+////  If LCD_QUEUE is defined lcd_send_byte() (and so lcd_putc(), printf   ////
+////  and lcd_gotoxy()) only places the byte in a LCD_QUEUE_SIZE entry ring////
+////  buffer and returns.  The application must call lcd_task() from a     ////
+////  timer ISR, LCD_QUEUE_INT names that interrupt (default INT_TIMER0).  ////
+////  Each call to lcd_task() sends one nibble, and a byte is only started ////
+////  once the busy flag is clear, so the tick can be as short as the ISR  ////
+////  overhead allows (50-200us is typical).  If the ring buffer is full   ////
+////  the caller runs the queue itself until a slot is free.  lcd_init()   ////
+////  and lcd_getc() always talk to the LCD directly.                      ////
+////                                                                       ////
+////  If LCD_WRITE_ONLY is defined the busy flag is never read.  Each byte ////
+////  is followed by a fixed wait instead, LCD_EXEC_US_HOME (1520us) after ////
+////  clear/home and LCD_EXEC_US (37us) after everything else.  The data   ////
+////  pins then never change direction, and with pin access LCD_RW_PIN may ////
+////  be left undefined and RW tied to ground.  lcd_getc() is only         ////
+////  available if LCD_SHADOW is also defined.  With LCD_QUEUE the waits   ////
+////  are counted in lcd_task() ticks, so LCD_QUEUE_TICK_US must be set to ////
+////  the tick period (at least 40us).                                     ////
+////                                                                       ////
+////  If LCD_BUSY_TIMEOUT is defined (without LCD_WRITE_ONLY) no busy flag ////
+////  wait lasts longer than LCD_BUSY_TIMEOUT_US (default 2000us), so a    ////
+////  missing or hung module cannot stall the rest of the program.  After  ////
+////  LCD_FAULT_TIMEOUTS (default 3) timeouts in a row the flag is no      ////
+////  longer read, lcd_fault() becomes TRUE and writes are timed as with   ////
+////  LCD_WRITE_ONLY.  Every LCD_FAULT_RETRY (default 250) characters      ////
+////  after that lcd_putc() checks whether the LCD answers: its address    ////
+////  counter has to read back two set-address commands.  A single "not    ////
+////  busy" read is not enough, floating or pulled down data lines give    ////
+////  that too.  If it answers it is re-initialised, which leaves it blank,////
+////  and lcd_fault() goes back to FALSE.  With LCD_QUEUE the busy flag is ////
+////  still polled once a tick, so LCD_QUEUE_TICK_US must be the tick      ////
+////  period.                                                              ////
+////                                                                       ////
+////  The lcd_putc() that makes the attempt takes, counting delays only    ////
+////  (tools/lcd_host/recover.c):                                          ////
+////     still no answer    about 0.13ms                                   ////
+////     answers            35ms for lcd_init() plus up to four            ////
+////                        LCD_BUSY_TIMEOUT_US waits, 43ms at most        ////
+////  With LCD_QUEUE add 1.52ms, and first the time to send whatever is    ////
+////  queued (two ticks a byte, 1.52ms for a clear or home).  With         ////
+////  LCD_INIT_ASYNC the reset runs from the tick instead of the 35ms.     ////
+////                                                                       ////
+////  If LCD_INIT_ASYNC is defined (it implies LCD_QUEUE) lcd_init() only  ////
+////  sets up the pins and returns at once.  The power-up wait and reset   ////
+////  nibbles are then sent by lcd_task() ticks, 15ms plus 4 x 5ms counted ////
+////  in LCD_QUEUE_TICK_US (default 128us) periods.  Anything written before////
+////  then waits in the queue behind the init string, so the application can////
+////  start its own work straight after lcd_init().                        ////
+////                                                                       ////
+////  If LCD_FRAME_HZ is defined (it implies LCD_SHADOW and LCD_QUEUE)     ////
+////  lcd_task() also counts out frames of 1/LCD_FRAME_HZ seconds, in      ////
+////  LCD_QUEUE_TICK_US (default 128us) ticks.  The application writes the ////
+////  shadow as often as it likes and calls lcd_frame() from its loop, so  ////
+////  the display is updated at most LCD_FRAME_HZ times a second (10-20 is ////
+////  plenty to read) however fast the loop runs.                          ////
+////                                                                       ////
+////  If LCD_MINIMAL is defined only what a small 2 line display needs is  ////
+////  compiled, for parts with 2K words of ROM.  lcd_getc(), the CGRAM     ////
+////  functions, LCD_EXTENDED_NEWLINE and the software cursor are left out:////
+////  lcd_gotoxy() always sends the address (any y other than 1 is line    ////
+////  two), \b is a cursor-left command and lcd_putc() just writes data.   ////
+////  It cannot be combined with LCD_SHADOW, LCD_QUEUE or the CGRAM        ////
+////  options.  Add LCD_WRITE_ONLY to drop the read path too.  To leave    ////
+////  printf out as well print text with lcd_putc("text") and numbers with ////
+////  numfmt.c, e.g. fmt_puts(lcd_putc, fmt_u8(value, 1)) for "%u".        ////
+////                                                                       ////
+////  What those pieces cost, from LCD_ADC_BUTTON's baseline Debug.lst     ////
+////  (stock driver and printf, PCM: 646 words, RAM 9 bytes in main(), 21  ////
+////  worst case), via tools/ccs_lst/lst_cost.py rom:                      ////
+////     lcd_read_byte + lcd_read_nibble  133 words, LCD_WRITE_ONLY        ////
+////     @PRINTF_U + @DIV88                74 words, numfmt instead        ////
+////     lcd_init 67, lcd_putc 44, lcd_send_nibble 44, @delay_ms1 19,      ////
+////     lcd_gotoxy 18, lcd_send_byte 8                                    ////
+////  The LCD_MINIMAL and LCD_MINIMAL + LCD_WRITE_ONLY builds have not     ////
+////  been compiled yet, so their own ROM and RAM are not measured.        ////
+////  Dual_ADC's main.lst was built from an older main.c (no printf in     ////
+////  it), so it gives no baseline for that project.                       ////
+////                                                                       ////
+////  If LCD_BARGRAPH is defined (it implies LCD_CGRAM_CACHE) lcd_bar() uses////
+////  four CGRAM slots from LCD_BAR_CGRAM (default 4, so slots 4-7) for the////
+////  partly filled cell and character 0xFF for full cells.                ////
+////                                                                       ////
+////  If LCD_MARQUEE is defined rows can scroll text wider than the display.////
+////  The HD44780 display-shift command moves every line at once, so it is ////
+////  only used on 2 line displays (LCD_ROWS 2) while both rows scroll     ////
+////  (give lcd_marquee() "" for a row that should stay blank) and both    ////
+////  texts leave LCD_MARQUEE_GAP spaces free in the 40 character DDRAM    ////
+////  line.  The text is then written once across the whole line and each  ////
+////  step is one command.  Anything else, including all 4 line            ////
+////  displays whose rows share the DDRAM lines, scrolls in software by    ////
+////  rewriting the row (LCD_LINE_LENGTH characters a step, only the ones  ////
+////  that change with LCD_SHADOW), with LCD_MARQUEE_GAP (default 4) spaces////
+////  between the end of the text and its start.  While the display is     ////
+////  shifted lcd_gotoxy() positions move with it, and leaving hardware    ////
+////  scrolling sends a return home (1.52ms) to undo the shift.            ////
+////                                                                       ////
+///////////////////////////////////////////////////////////////////////////////
+////        (C) Copyright 1996,2010 Custom Computer Services           ////
+//// This source code may only be used by licensed users of the CCS C  ////
+//// compiler.  This source code may only be distributed to other      ////
+//// licensed users of the CCS C compiler.  No other use, reproduction ////
+//// or distribution is permitted without written permission.          ////
+//// Derivative programs created using this software in object code    ////
+//// form are not restricted in any way.                               ////
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef __LCD_C__
+#define __LCD_C__
+
+// define the pinout.
+// only required if port access is being used.
+typedef struct  
+{                            // This structure is overlayed
+   int1 enable;           // on to an I/O port to gain
+   int1 rs;               // access to the LCD pins.
+   int1 rw;               // The bits are allocated from
+   int1 unused;           // low order up.  ENABLE will
+   unsigned int     data : 4;         // be LSB pin of that port.
+  #if defined(__PCD__)       // The port used will be LCD_DATA_PORT.
+   unsigned int    reserved: 8;
+  #endif
+} LCD_PIN_MAP;
+
+// this is to improve compatability with previous LCD drivers that accepted
+// a define labeled 'use_portb_lcd' that configured the LCD onto port B.
+#if ((defined(use_portb_lcd)) && (use_portb_lcd==TRUE))
+ #define LCD_DATA_PORT getenv("SFR:PORTB")
+#endif
+
+#if defined(__PCB__)
+   // these definitions only need to be modified for baseline PICs.
+   // all other PICs use LCD_PIN_MAP or individual LCD_xxx pin definitions.
+/*                                    EN, RS,   RW,   UNUSED,  DATA  */
+ const LCD_PIN_MAP LCD_OUTPUT_MAP =  {0,  0,    0,    0,       0};
+ const LCD_PIN_MAP LCD_INPUT_MAP =   {0,  0,    0,    0,       0xF};
+#endif
+
+////////////////////// END CONFIGURATION ///////////////////////////////////
+
+#if defined(LCD_FRAME_HZ)
+ #if !defined(LCD_SHADOW)
+   #define LCD_SHADOW
+ #endif
+ #if !defined(LCD_QUEUE)
+   #define LCD_QUEUE
+ #endif
+#endif
+
+#if defined(LCD_BARGRAPH) && !defined(LCD_CGRAM_CACHE)
+ #define LCD_CGRAM_CACHE
+#endif
+
+#if defined(LCD_CGRAM_CACHE)
+// copy of what each CGRAM slot holds, CGRAM is undefined at power up.
+// declared up here so lcd_init() can mark every slot unknown again.
+unsigned int8 g_LcdCgram[8][8];
+int1 g_LcdCgramValid[8];
+#endif
+
+#if defined(LCD_MINIMAL)
+ #if (defined(LCD_SHADOW) || defined(LCD_QUEUE) || defined(LCD_INIT_ASYNC) || defined(LCD_CGRAM_CACHE) || defined(LCD_BARGRAPH) || defined(LCD_MARQUEE))
+   #error LCD_MINIMAL cannot be used with LCD_SHADOW, LCD_QUEUE, LCD_INIT_ASYNC, LCD_MARQUEE or the CGRAM options
+ #endif
+ #undef LCD_EXTENDED_NEWLINE
+#endif
+
+#if (defined(LCD_PCF8574) || defined(LCD_74HC595))
+ #define LCD_SERIAL
+ #if !defined(LCD_WRITE_ONLY)
+   #define LCD_WRITE_ONLY      // the busy flag is not read back through the expander
+ #endif
+#endif
+
+#if defined(LCD_WRITE_ONLY)
+ #undef LCD_BUSY_TIMEOUT       // there is no busy flag to wait for
+#endif
+
+#if defined(LCD_SERIAL)
+ #ifndef LCD_SERIAL_RS
+   #define LCD_SERIAL_RS   0x01
+   #define LCD_SERIAL_RW   0x02
+   #define LCD_SERIAL_E    0x04
+   #define LCD_SERIAL_BL   0x08     // backlight
+ #endif                             // D4-D7 are always bits 4-7
+
+// expander outputs other than E and the data bits, RW stays low
+unsigned int8 g_LcdBus = LCD_SERIAL_BL;
+
+   #define lcd_output_enable(x)     // E is pulsed inside each burst
+   #define lcd_enable_tris()
+   #define lcd_output_rs(x) g_LcdBus = (x) ? (g_LcdBus | LCD_SERIAL_RS) : (g_LcdBus & ~LCD_SERIAL_RS)
+   #define lcd_rs_tris()
+   #define lcd_output_rw(x)
+   #define lcd_rw_tris()
+#else
+#ifndef LCD_ENABLE_PIN
+   #define lcd_output_enable(x) lcdlat.enable=x
+   #define lcd_enable_tris()   lcdtris.enable=0
+#else
+   #define lcd_output_enable(x) output_bit(LCD_ENABLE_PIN, x)
+   #define lcd_enable_tris()  output_drive(LCD_ENABLE_PIN)
+#endif
+
+#ifndef LCD_RS_PIN
+   #define lcd_output_rs(x) lcdlat.rs=x
+   #define lcd_rs_tris()   lcdtris.rs=0
+#else
+   #define lcd_output_rs(x) output_bit(LCD_RS_PIN, x)
+   #define lcd_rs_tris()  output_drive(LCD_RS_PIN)
+#endif
+
+#ifndef LCD_RW_PIN
+ #if (defined(LCD_WRITE_ONLY) && defined(LCD_DATA4))
+   #define lcd_output_rw(x)              // RW tied to ground
+   #define lcd_rw_tris()
+ #else
+   #define lcd_output_rw(x) lcdlat.rw=x
+   #define lcd_rw_tris()   lcdtris.rw=0
+ #endif
+#else
+   #define lcd_output_rw(x) output_bit(LCD_RW_PIN, x)
+   #define lcd_rw_tris()  output_drive(LCD_RW_PIN)
+#endif
+#endif   //LCD_SERIAL not defined
+
+// original version of this library incorrectly labeled LCD_DATA0 as LCD_DATA4,
+// LCD_DATA1 as LCD_DATA5, and so on.  this block of code makes the driver
+// compatible with any code written for the original library
+#if (defined(LCD_DATA0) && defined(LCD_DATA1) && defined(LCD_DATA2) && defined(LCD_DATA3) && !defined(LCD_DATA4) && !defined(LCD_DATA5) && !defined(LCD_DATA6) && !defined(LCD_DATA7))
+   #define  LCD_DATA4    LCD_DATA0
+   #define  LCD_DATA5    LCD_DATA1
+   #define  LCD_DATA6    LCD_DATA2
+   #define  LCD_DATA7    LCD_DATA3
+#endif
+
+// all eight data pins given, run the LCD with an 8 bit bus.  in this mode
+// lcd_send_nibble() and lcd_read_nibble() move the whole byte.
+#if (defined(LCD_DATA0) && defined(LCD_DATA1) && defined(LCD_DATA2) && defined(LCD_DATA3) && defined(LCD_DATA4) && defined(LCD_DATA5) && defined(LCD_DATA6) && defined(LCD_DATA7))
+   #define LCD_BUS8
+   #define LCD_FUNCTION_SET   0x30     // DL=1
+   #define LCD_RESET_NIBBLE   0x30     // 3 on D4:D7
+   #define LCD_RESET_LAST     0x30     // stay in 8 bit mode
+#else
+   #define LCD_FUNCTION_SET   0x20     // DL=0
+   #define LCD_RESET_NIBBLE   3
+   #define LCD_RESET_LAST     2        // switch to 4 bit mode
+#endif
+
+// pin access with D4:D7 on four consecutive bits of one port, the nibble
+// can then be moved with one masked write instead of four pin writes.  the
+// same goes for D0:D7 on all eight bits of one port in 8 bit mode.
+#if (defined(LCD_DATA4) && defined(LCD_DATA5) && defined(LCD_DATA6) && defined(LCD_DATA7) && !defined(__PCB__) && !defined(__PCD__))
+ #if defined(LCD_BUS8)
+  #if (((LCD_DATA0 & 7) == 0) && (LCD_DATA1 == LCD_DATA0+1) && (LCD_DATA2 == LCD_DATA0+2) && (LCD_DATA3 == LCD_DATA0+3) && (LCD_DATA4 == LCD_DATA0+4) && (LCD_DATA5 == LCD_DATA0+5) && (LCD_DATA6 == LCD_DATA0+6) && (LCD_DATA7 == LCD_DATA0+7))
+   #define LCD_DATA_CONTIGUOUS
+   #define LCD_DATA_SHIFT   0
+   #define LCD_DATA_MASK    0xFF
+  #endif
+ #elif ((LCD_DATA5 == LCD_DATA4+1) && (LCD_DATA6 == LCD_DATA4+2) && (LCD_DATA7 == LCD_DATA4+3) && ((LCD_DATA4 & 7) <= 4))
+   #define LCD_DATA_CONTIGUOUS
+   #define LCD_DATA_SHIFT   (LCD_DATA4 & 7)
+   #define LCD_DATA_MASK    (0x0F << LCD_DATA_SHIFT)
+ #endif
+
+ #if defined(LCD_DATA_CONTIGUOUS)
+   unsigned int8 lcd_data_port, lcd_data_lat, lcd_data_tris;
+   #byte lcd_data_port = LCD_DATA7/8
+  #if defined(__PCH__)
+   #byte lcd_data_lat = LCD_DATA7/8+9
+   #byte lcd_data_tris = LCD_DATA7/8+0x12
+  #else
+   #byte lcd_data_lat = LCD_DATA7/8
+   #byte lcd_data_tris = LCD_DATA7/8+0x80
+  #endif
+
+   #define lcd_data_float()   lcd_data_tris |= LCD_DATA_MASK
+   #define lcd_data_drive()   lcd_data_tris &= (unsigned int8)~LCD_DATA_MASK
+ #endif
+#endif
+
+#if (!defined(LCD_DATA4) && !defined(LCD_SERIAL))
+#ifndef LCD_DATA_PORT
+   #if defined(__PCB__)
+      #define LCD_DATA_PORT      0x06     //portb
+      #define set_tris_lcd(x)   set_tris_b(x)
+   #else
+     #if defined(PIN_D0)
+      #define LCD_DATA_PORT      getenv("SFR:PORTD")     //portd
+     #else
+      #define LCD_DATA_PORT      getenv("SFR:PORTB")     //portb
+     #endif
+   #endif   
+#endif
+
+#if defined(__PCB__)
+   LCD_PIN_MAP lcd, lcdlat;
+   #byte lcd = LCD_DATA_PORT
+   #byte lcdlat = LCD_DATA_PORT
+#elif defined(__PCM__)
+   LCD_PIN_MAP lcd, lcdlat, lcdtris;
+   #byte lcd = LCD_DATA_PORT
+   #byte lcdlat = LCD_DATA_PORT
+   #byte lcdtris = LCD_DATA_PORT+0x80
+#elif defined(__PCH__)
+   LCD_PIN_MAP lcd, lcdlat, lcdtris;
+   #byte lcd = LCD_DATA_PORT
+   #byte lcdlat = LCD_DATA_PORT+9
+   #byte lcdtris = LCD_DATA_PORT+0x12
+#elif defined(__PCD__)
+   LCD_PIN_MAP lcd, lcdlat, lcdtris;
+   #word lcd = LCD_DATA_PORT
+   #word lcdlat = LCD_DATA_PORT+2
+   #word lcdtris = LCD_DATA_PORT-0x02
+#endif
+#endif   //LCD_DATA4 and LCD_SERIAL not defined
+
+#ifndef LCD_TYPE
+   #define LCD_TYPE 2           // 0=5x7, 1=5x10, 2=2 lines
+#endif
+
+#ifndef LCD_LINE_TWO
+   #define LCD_LINE_TWO 0x40    // LCD RAM address for the second line
+#endif
+
+#ifndef LCD_LINE_LENGTH
+   #define LCD_LINE_LENGTH 20
+#endif
+
+#ifndef LCD_ROWS
+   #define LCD_ROWS 2           // set to 4 for 20x4 modules
+#endif
+
+// 4 line modules are a 2 line controller with each DDRAM line split in two,
+// lines three and four continue on from lines one and two.
+#ifndef LCD_LINE_THREE
+   #define LCD_LINE_THREE LCD_LINE_LENGTH
+#endif
+
+#ifndef LCD_LINE_FOUR
+   #define LCD_LINE_FOUR (LCD_LINE_TWO + LCD_LINE_LENGTH)
+#endif
+
+#if (defined(LCD_WRITE_ONLY) || defined(LCD_BUSY_TIMEOUT))
+// there is no busy flag to poll (or it stopped answering), so wait out the
+// worst case execution time from the HD44780 datasheet instead.  delay_us()
+// is already scaled to the #use delay clock by the compiler.
+ #ifndef LCD_EXEC_US
+   #define LCD_EXEC_US        37       // data writes and most commands
+ #endif
+ #ifndef LCD_EXEC_US_HOME
+   #define LCD_EXEC_US_HOME   1520     // clear display and return home
+ #endif
+ #define lcd_slow_command(address, n)   (!(address) && (n) && ((n) < 4))
+#endif
+
+#if !defined(LCD_WRITE_ONLY)
+unsigned int8 lcd_read_nibble(void);
+
+unsigned int8 lcd_read_byte(void)
+{
+   unsigned int8 high;
+  #if !defined(LCD_BUS8)
+   unsigned int8 low;
+  #endif
+
+ #if defined(__PCB__)
+   set_tris_lcd(LCD_INPUT_MAP);
+ #else
+  #if defined(LCD_DATA_CONTIGUOUS)
+   lcd_data_float();
+  #elif (defined(LCD_DATA4) && defined(LCD_DATA5) && defined(LCD_DATA6) && defined(LCD_DATA7))
+   #if defined(LCD_BUS8)
+   output_float(LCD_DATA0);
+   output_float(LCD_DATA1);
+   output_float(LCD_DATA2);
+   output_float(LCD_DATA3);
+   #endif
+   output_float(LCD_DATA4);
+   output_float(LCD_DATA5);
+   output_float(LCD_DATA6);
+   output_float(LCD_DATA7);
+  #else
+   lcdtris.data = 0xF;
+  #endif
+ #endif
+        
+   lcd_output_rw(1);
+   delay_cycles(1);
+   lcd_output_enable(1);
+   delay_cycles(1);
+   high = lcd_read_nibble();
+      
+   lcd_output_enable(0);
+  #if !defined(LCD_BUS8)
+   delay_cycles(1);
+   lcd_output_enable(1);
+   delay_us(1);
+   low = lcd_read_nibble();
+      
+   lcd_output_enable(0);
+  #endif
+
+ #if defined(__PCB__)
+   set_tris_lcd(LCD_OUTPUT_MAP);
+ #else
+  #if defined(LCD_DATA_CONTIGUOUS)
+   lcd_data_drive();
+  #elif (defined(LCD_DATA4) && defined(LCD_DATA5) && defined(LCD_DATA6) && defined(LCD_DATA7))
+   #if defined(LCD_BUS8)
+   output_drive(LCD_DATA0);
+   output_drive(LCD_DATA1);
+   output_drive(LCD_DATA2);
+   output_drive(LCD_DATA3);
+   #endif
+   output_drive(LCD_DATA4);
+   output_drive(LCD_DATA5);
+   output_drive(LCD_DATA6);
+   output_drive(LCD_DATA7);
+  #else
+   lcdtris.data = 0x0;
+  #endif
+ #endif
+
+  #if defined(LCD_BUS8)
+   return(high);              // the whole byte in one read
+  #else
+   return( (high<<4) | low);
+  #endif
+}
+
+unsigned int8 lcd_read_nibble(void)
+{
+  #if defined(LCD_DATA_CONTIGUOUS)
+   return((lcd_data_port >> LCD_DATA_SHIFT) & (LCD_DATA_MASK >> LCD_DATA_SHIFT));
+  #elif (defined(LCD_DATA4) && defined(LCD_DATA5) && defined(LCD_DATA6) && defined(LCD_DATA7))
+   unsigned int8 n = 0x00;
+
+   /* Read the data port */
+   #if defined(LCD_BUS8)
+   n |= input(LCD_DATA0);
+   n |= input(LCD_DATA1) << 1;
+   n |= input(LCD_DATA2) << 2;
+   n |= input(LCD_DATA3) << 3;
+   n |= input(LCD_DATA4) << 4;
+   n |= input(LCD_DATA5) << 5;
+   n |= input(LCD_DATA6) << 6;
+   n |= input(LCD_DATA7) << 7;
+   #else
+   n |= input(LCD_DATA4);
+   n |= input(LCD_DATA5) << 1;
+   n |= input(LCD_DATA6) << 2;
+   n |= input(LCD_DATA7) << 3;
+   #endif
+   
+   return(n);
+  #else
+   return(lcd.data);
+  #endif
+}
+#endif   //LCD_WRITE_ONLY not defined
+
+#if defined(LCD_BUSY_TIMEOUT)
+#ifndef LCD_BUSY_TIMEOUT_US
+   #define LCD_BUSY_TIMEOUT_US  2000   // longer than the slowest command
+#endif
+#ifndef LCD_BUSY_POLL_US
+   #define LCD_BUSY_POLL_US     10
+#endif
+#ifndef LCD_FAULT_TIMEOUTS
+   #define LCD_FAULT_TIMEOUTS   3      // timeouts in a row before the fault
+#endif
+#ifndef LCD_FAULT_RETRY
+   #define LCD_FAULT_RETRY      250    // characters between recovery attempts
+#endif
+
+unsigned int8 g_LcdTimeouts;           // busy waits in a row that ran out
+int1 g_LcdFault;                       // not answering, writes are timed
+unsigned int8 g_LcdRetry;              // characters until the next attempt
+
+#define lcd_fault()   (g_LcdFault)
+
+#define lcd_busy_timeout()  { if (++g_LcdTimeouts >= LCD_FAULT_TIMEOUTS) \
+                              { g_LcdFault = 1; g_LcdRetry = LCD_FAULT_RETRY; } }
+
+// wait for the busy flag to clear, for LCD_BUSY_TIMEOUT_US at most (the
+// time spent reading the flag makes it a little longer).  does not read
+// the flag at all once the LCD is faulted.
+void lcd_wait_ready(void)
+{
+   unsigned int16 polls;
+
+   if (g_LcdFault)
+      return;
+   lcd_output_rs(0);
+   for (polls = LCD_BUSY_TIMEOUT_US / LCD_BUSY_POLL_US; polls; polls--)
+   {
+      if (!bit_test(lcd_read_byte(),7))
+      {
+         g_LcdTimeouts = 0;
+         return;
+      }
+      delay_us(LCD_BUSY_POLL_US);
+   }
+   lcd_busy_timeout();
+}
+#endif
+
+#if defined(LCD_SERIAL)
+#if defined(LCD_PCF8574)
+ #ifndef LCD_PCF8574_ADDR
+   #define LCD_PCF8574_ADDR 0x4E     // 0x27 write address, PCF8574A is 0x7E
+ #endif
+
+// one I2C transaction, the expander updates its outputs after each byte
+void lcd_serial_burst(unsigned int8 *b, unsigned int8 count)
+{
+   unsigned int8 i;
+
+   i2c_start();
+   i2c_write(LCD_PCF8574_ADDR);
+   for(i=0; i<count; i++)
+      i2c_write(b[i]);
+   i2c_stop();
+}
+#else
+// each byte is shifted in, then latched onto the outputs with RCLK
+void lcd_serial_burst(unsigned int8 *b, unsigned int8 count)
+{
+   unsigned int8 i;
+
+   for(i=0; i<count; i++)
+   {
+      spi_write(b[i]);
+      output_high(LCD_595_LATCH_PIN);
+      output_low(LCD_595_LATCH_PIN);
+   }
+}
+#endif
+
+// nibble n with E high then low, used by the reset sequence
+void lcd_send_nibble(unsigned int8 n)
+{
+   unsigned int8 b[2];
+
+   b[0] = g_LcdBus | (n << 4) | LCD_SERIAL_E;
+   b[1] = b[0] & ~LCD_SERIAL_E;
+   lcd_serial_burst(b, 2);
+}
+
+// a whole byte in one burst, both nibbles with E high then low
+void lcd_serial_byte(unsigned int8 address, unsigned int8 n)
+{
+   unsigned int8 b[4];
+
+   lcd_output_rs(address);
+   b[0] = g_LcdBus | (n & 0xF0) | LCD_SERIAL_E;
+   b[1] = b[0] & ~LCD_SERIAL_E;
+   b[2] = g_LcdBus | (n << 4) | LCD_SERIAL_E;
+   b[3] = b[2] & ~LCD_SERIAL_E;
+   lcd_serial_burst(b, 4);
+}
+
+void lcd_write_byte(unsigned int8 address, unsigned int8 n)
+{
+   lcd_serial_byte(address, n);
+
+   if (lcd_slow_command(address, n))
+      delay_us(LCD_EXEC_US_HOME);
+   else
+      delay_us(LCD_EXEC_US);
+}
+#else
+void lcd_send_nibble(unsigned int8 n)
+{
+  #if (defined(LCD_DATA_CONTIGUOUS) && (LCD_DATA_MASK == 0xFF))
+   lcd_data_lat = n;          // the whole port is the bus
+  #elif defined(LCD_DATA_CONTIGUOUS)
+   // not atomic: no ISR may write the other pins of this port (see above)
+   lcd_data_lat = (lcd_data_lat & ~LCD_DATA_MASK) | (n << LCD_DATA_SHIFT);
+  #elif (defined(LCD_DATA4) && defined(LCD_DATA5) && defined(LCD_DATA6) && defined(LCD_DATA7))
+   /* Write to the data port */
+   #if defined(LCD_BUS8)
+   output_bit(LCD_DATA0, bit_test(n, 0));
+   output_bit(LCD_DATA1, bit_test(n, 1));
+   output_bit(LCD_DATA2, bit_test(n, 2));
+   output_bit(LCD_DATA3, bit_test(n, 3));
+   output_bit(LCD_DATA4, bit_test(n, 4));
+   output_bit(LCD_DATA5, bit_test(n, 5));
+   output_bit(LCD_DATA6, bit_test(n, 6));
+   output_bit(LCD_DATA7, bit_test(n, 7));
+   #else
+   output_bit(LCD_DATA4, bit_test(n, 0));
+   output_bit(LCD_DATA5, bit_test(n, 1));
+   output_bit(LCD_DATA6, bit_test(n, 2));
+   output_bit(LCD_DATA7, bit_test(n, 3));
+   #endif
+  #else      
+   lcdlat.data = n;
+  #endif
+      
+   delay_cycles(1);
+   lcd_output_enable(1);
+   delay_us(2);
+   lcd_output_enable(0);
+}
+
+void lcd_write_byte(unsigned int8 address, unsigned int8 n)
+{
+  #if defined(__PCB__)
+   set_tris_lcd(LCD_OUTPUT_MAP);
+  #else
+   lcd_enable_tris();
+   lcd_rs_tris();
+   lcd_rw_tris();
+  #endif
+
+  #if defined(LCD_BUSY_TIMEOUT)
+   lcd_wait_ready();
+  #elif !defined(LCD_WRITE_ONLY)
+   lcd_output_rs(0);
+   while ( bit_test(lcd_read_byte(),7) ) ;
+  #endif
+   lcd_output_rs(address);
+   delay_cycles(1);
+   lcd_output_rw(0);
+   delay_cycles(1);
+   lcd_output_enable(0);
+  #if defined(LCD_BUS8)
+   lcd_send_nibble(n);
+  #else
+   lcd_send_nibble(n >> 4);
+   lcd_send_nibble(n & 0xf);
+  #endif
+
+  #if defined(LCD_WRITE_ONLY)
+   if (lcd_slow_command(address, n))
+      delay_us(LCD_EXEC_US_HOME);
+   else
+      delay_us(LCD_EXEC_US);
+  #elif defined(LCD_BUSY_TIMEOUT)
+   if (g_LcdFault)
+   {
+      if (lcd_slow_command(address, n))
+         delay_us(LCD_EXEC_US_HOME);
+      else
+         delay_us(LCD_EXEC_US);
+   }
+  #endif
+}
+#endif   //LCD_SERIAL not defined
+
+#if defined(LCD_INIT_ASYNC) && !defined(LCD_QUEUE)
+ #define LCD_QUEUE
+#endif
+
+#if defined(LCD_QUEUE) && defined(LCD_PCF8574)
+ #error LCD_PCF8574 cannot be used with LCD_QUEUE, LCD_INIT_ASYNC or LCD_FRAME_HZ, the I2C burst is too long for the tick ISR
+#endif
+
+#if defined(LCD_QUEUE)
+#ifndef LCD_QUEUE_SIZE
+   #define LCD_QUEUE_SIZE 32           // must be a power of 2
+#endif
+
+#ifndef LCD_QUEUE_INT
+   #define LCD_QUEUE_INT INT_TIMER0    // interrupt whose ISR calls lcd_task()
+#endif
+
+#if (defined(LCD_WRITE_ONLY) || defined(LCD_INIT_ASYNC) || defined(LCD_FRAME_HZ) || defined(LCD_BUSY_TIMEOUT))
+ #ifndef LCD_QUEUE_TICK_US
+   #define LCD_QUEUE_TICK_US 128       // period of the lcd_task() tick
+ #endif
+#endif
+
+#if (defined(LCD_WRITE_ONLY) || defined(LCD_BUSY_TIMEOUT))
+ // one tick always passes between bytes, so only clear/home needs extra
+ #define LCD_QUEUE_HOME_TICKS   (LCD_EXEC_US_HOME / LCD_QUEUE_TICK_US)
+unsigned int8 g_LcdQWait;              // ticks left before the next byte
+#endif
+
+#if defined(LCD_BUSY_TIMEOUT)
+#define LCD_BUSY_TICKS   (LCD_BUSY_TIMEOUT_US / LCD_QUEUE_TICK_US + 1)
+
+unsigned int8 g_LcdBusyTicks;          // ticks the LCD has been busy for
+
+// the busy flag check for one tick.  TRUE when the next byte can go, which
+// is also the case once the LCD has been busy for LCD_BUSY_TIMEOUT_US.
+int1 lcd_task_ready(void)
+{
+   if (g_LcdFault)
+      return(TRUE);
+   lcd_output_rs(0);
+   if (!bit_test(lcd_read_byte(),7))
+      g_LcdTimeouts = 0;
+   else if (++g_LcdBusyTicks < LCD_BUSY_TICKS)
+      return(FALSE);
+   else
+   {
+      lcd_busy_timeout();
+   }
+   g_LcdBusyTicks = 0;
+   return(TRUE);
+}
+#endif
+
+// lcd_send_byte() only moves the head and lcd_task() only moves the tail,
+// so neither side needs to mask interrupts to touch the ring buffer.
+unsigned int8 g_LcdQData[LCD_QUEUE_SIZE];
+int1 g_LcdQRs[LCD_QUEUE_SIZE];
+unsigned int8 g_LcdQHead, g_LcdQTail;
+int1 g_LcdQLow;                        // high nibble of the tail entry sent
+
+#if defined(LCD_INIT_ASYNC)
+#define LCD_INIT_TICKS(ms)   ((ms) * 1000 / LCD_QUEUE_TICK_US + 1)
+
+unsigned int8 g_LcdInitStep;           // reset nibbles still to send
+unsigned int16 g_LcdInitWait;          // ticks before the next one
+
+#define lcd_init_busy()   (g_LcdInitStep || g_LcdInitWait)
+
+// one tick of the power-up reset (3, 3, 3 then 2, 5ms apart).  the busy
+// flag cannot be read until the LCD is in 4 bit mode, so it is all timed.
+// returns TRUE while the reset is still running.
+int1 lcd_init_task(void)
+{
+   if (g_LcdInitWait)
+   {
+      g_LcdInitWait--;
+      return(TRUE);
+   }
+   if (!g_LcdInitStep)
+      return(FALSE);
+
+   lcd_send_nibble((g_LcdInitStep == 1) ? LCD_RESET_LAST : LCD_RESET_NIBBLE);
+   g_LcdInitStep--;
+   g_LcdInitWait = LCD_INIT_TICKS(5);
+   return(TRUE);
+}
+#endif
+
+#if defined(LCD_FRAME_HZ)
+#define LCD_FRAME_TICKS   (1000000 / LCD_FRAME_HZ / LCD_QUEUE_TICK_US)
+
+unsigned int16 g_LcdFrameTicks;        // ticks into the current frame
+int1 g_LcdFrameDue;                    // set by lcd_task(), cleared by lcd_frame()
+
+#define lcd_frame_due()   (g_LcdFrameDue)
+#endif
+
+void lcd_task(void)
+{
+   unsigned int8 n;
+
+  #if defined(LCD_FRAME_HZ)
+   if (++g_LcdFrameTicks >= LCD_FRAME_TICKS)
+   {
+      g_LcdFrameTicks = 0;
+      g_LcdFrameDue = 1;
+   }
+  #endif
+  #if defined(LCD_INIT_ASYNC)
+   if (lcd_init_task())
+      return;
+  #endif
+   if (g_LcdQTail == g_LcdQHead)
+      return;
+   n = g_LcdQData[g_LcdQTail];
+
+   if (!g_LcdQLow)
+   {
+     #if (defined(LCD_WRITE_ONLY) || defined(LCD_BUSY_TIMEOUT))
+      if (g_LcdQWait)
+      {
+         g_LcdQWait--;
+         return;
+      }
+     #endif
+     #if defined(LCD_BUSY_TIMEOUT)
+      if (!lcd_task_ready())
+         return;                       // still busy, try again next tick
+     #elif !defined(LCD_WRITE_ONLY)
+      lcd_output_rs(0);
+      if ( bit_test(lcd_read_byte(),7) )
+         return;                       // still busy, try again next tick
+     #endif
+     #if defined(LCD_SERIAL)
+      lcd_serial_byte(g_LcdQRs[g_LcdQTail], n);   // whole byte, one burst
+     #else
+      lcd_output_rs(g_LcdQRs[g_LcdQTail]);
+      delay_cycles(1);
+      lcd_output_rw(0);
+      delay_cycles(1);
+      lcd_output_enable(0);
+      #if defined(LCD_BUS8)
+      lcd_send_nibble(n);     // whole byte, done in one tick
+      #else
+      lcd_send_nibble(n >> 4);
+      g_LcdQLow = 1;
+      return;
+      #endif
+     #endif
+   }
+  #if (!defined(LCD_BUS8) && !defined(LCD_SERIAL))
+   else
+   {
+      lcd_send_nibble(n & 0xf);
+      g_LcdQLow = 0;
+   }
+  #endif
+
+  #if defined(LCD_WRITE_ONLY)
+   if (lcd_slow_command(g_LcdQRs[g_LcdQTail], n))
+      g_LcdQWait = LCD_QUEUE_HOME_TICKS;
+  #elif defined(LCD_BUSY_TIMEOUT)
+   if (g_LcdFault && lcd_slow_command(g_LcdQRs[g_LcdQTail], n))
+      g_LcdQWait = LCD_QUEUE_HOME_TICKS;
+  #endif
+   g_LcdQTail = (g_LcdQTail + 1) & (LCD_QUEUE_SIZE - 1);
+}
+
+int1 lcd_idle(void)
+{
+   return(g_LcdQTail == g_LcdQHead);
+}
+
+// run the queue from the caller, used when the ring buffer is full and
+// before anything that has to talk to the LCD directly
+void lcd_task_sync(void)
+{
+  #if defined(LCD_WRITE_ONLY)
+   delay_us(LCD_QUEUE_TICK_US);        // stand in for the missing tick
+  #elif defined(LCD_INIT_ASYNC)
+   if (lcd_init_busy())
+      delay_us(LCD_QUEUE_TICK_US);
+  #endif
+   disable_interrupts(LCD_QUEUE_INT);
+   lcd_task();
+  #if defined(LCD_BUSY_TIMEOUT)
+   // the busy and clear/home waits are counted in ticks, so with the tick
+   // masked each poll from here has to be a tick apart as well
+   while ((g_LcdBusyTicks || g_LcdQWait) && !lcd_idle())
+   {
+      delay_us(LCD_QUEUE_TICK_US);
+      lcd_task();
+   }
+  #endif
+   enable_interrupts(LCD_QUEUE_INT);
+}
+
+void lcd_send_byte(unsigned int8 address, unsigned int8 n)
+{
+   unsigned int8 next;
+
+   next = (g_LcdQHead + 1) & (LCD_QUEUE_SIZE - 1);
+   while (next == g_LcdQTail)          // full, fall back to blocking
+      lcd_task_sync();
+
+   g_LcdQData[g_LcdQHead] = n;
+   g_LcdQRs[g_LcdQHead] = address;
+   g_LcdQHead = next;
+}
+#else
+ #define lcd_send_byte(address, n)   lcd_write_byte(address, n)
+#endif
+
+#if !defined(LCD_MINIMAL)
+// software copy of the cursor.  g_LcdX and g_LcdY (0 based) are where the
+// next character goes, g_LcdAddr is where the LCD's own address counter is
+// known to point.  lcd_gotoxy() and lcd_putc() only send a set-address
+// command when the two differ.
+#define LCD_ADDR_UNKNOWN   0xFF
+
+const unsigned int8 LCD_ROW_ADDRESS[4] = {0x00, LCD_LINE_TWO, LCD_LINE_THREE, LCD_LINE_FOUR};
+unsigned int8 g_LcdX, g_LcdY;
+unsigned int8 g_LcdAddr;
+
+#define lcd_cursor_address()   (LCD_ROW_ADDRESS[g_LcdY] + g_LcdX)
+#endif
+
+#if defined(LCD_SHADOW)
+// Shadow cells are numbered in the controller's own address order, cells
+// 0-39 are DDRAM 0x00-0x27 and cells 40-79 are DDRAM 0x40-0x67.  That way
+// a run of adjacent cells is a run of adjacent addresses, which the LCD's
+// address counter steps through by itself.
+#define LCD_SHADOW_SIZE    80
+#define lcd_cell_address(i)   (((i) < 40) ? (i) : ((i) + 0x18))
+
+unsigned int8 g_LcdShadow[LCD_SHADOW_SIZE];  // what the LCD should show
+int1 g_LcdDirty[LCD_SHADOW_SIZE];            // cell differs from the LCD
+int1 g_LcdAnyDirty;
+
+unsigned int8 lcd_address_cell(unsigned int8 address)
+{
+   if (address >= 0x40)
+      address -= 0x18;
+   if (address >= LCD_SHADOW_SIZE)
+      address = 0;
+   return(address);
+}
+
+void lcd_shadow_write(unsigned int8 cell, char c)
+{
+   if (g_LcdShadow[cell] != c)
+   {
+      g_LcdShadow[cell] = c;
+      g_LcdDirty[cell] = 1;
+      g_LcdAnyDirty = 1;
+   }
+}
+
+// blank the shadow, only cells that were not already blank get resent
+void lcd_shadow_clear(void)
+{
+   unsigned int8 i;
+
+   for (i = 0; i < LCD_SHADOW_SIZE; i++)
+      lcd_shadow_write(i, ' ');
+}
+
+void lcd_flush(void)
+{
+   unsigned int8 i, next;
+
+   if (!g_LcdAnyDirty)
+      return;
+   g_LcdAnyDirty = 0;
+
+   next = 0xFF;               // LCD address counter is not known yet
+   for (i = 0; i < LCD_SHADOW_SIZE; i++)
+   {
+      if (!g_LcdDirty[i])
+         continue;
+      g_LcdDirty[i] = 0;
+
+      if (i != next)          // start of a new run, move the LCD there
+         lcd_send_byte(0, 0x80 | lcd_cell_address(i));
+      lcd_send_byte(1, g_LcdShadow[i]);
+      next = i + 1;
+   }
+}
+
+#if defined(LCD_FRAME_HZ)
+int1 lcd_frame(void)
+{
+   if (!g_LcdFrameDue)
+      return(FALSE);
+   g_LcdFrameDue = 0;
+   lcd_flush();
+   return(TRUE);
+}
+#endif
+#endif
+
+#if defined(LCD_MINIMAL)
+ #define lcd_put_data(c)   lcd_send_byte(1, c)
+#else
+// write c at the cursor and advance it.  with LCD_WRAP (and without
+// LCD_EXTENDED_NEWLINE) the cursor wraps from the end of a row to the start
+// of the next row, rather than following the controller's 1-3-2-4 address
+// order.  a cursor that lcd_gotoxy() left past the end of every row (the
+// old lcd_gotoxy(21,1) way of reaching line three on a 2 row setup) never
+// wraps, it carries on in DDRAM order like the controller.
+void lcd_put_data(char c)
+{
+   unsigned int8 address;
+
+   address = lcd_cursor_address();
+  #if defined(LCD_SHADOW)
+   lcd_shadow_write(lcd_address_cell(address), c);
+  #else
+   if (address != g_LcdAddr)
+      lcd_send_byte(0, 0x80 | address);
+   lcd_send_byte(1, c);
+   g_LcdAddr = address + 1;
+  #endif
+
+   g_LcdX++;
+  #if (defined(LCD_WRAP) && !defined(LCD_EXTENDED_NEWLINE))
+   if (g_LcdX == LCD_LINE_LENGTH)
+   {
+      g_LcdX = 0;
+      if (++g_LcdY >= LCD_ROWS)
+         g_LcdY = 0;
+   }
+  #endif
+}
+#endif   //LCD_MINIMAL not defined
+
+void lcd_init(void) 
+{
+   unsigned int8 i;
+   unsigned int8 LCD_INIT_STRING[4] = {LCD_FUNCTION_SET | (LCD_TYPE << 2), 0xc, 1, 6};
+                             // These bytes need to be sent to the LCD
+                             // to start it up.
+   
+
+  #if defined(LCD_QUEUE)
+   g_LcdQHead = 0;
+   g_LcdQTail = 0;
+   g_LcdQLow = 0;
+   #if (defined(LCD_WRITE_ONLY) || defined(LCD_BUSY_TIMEOUT))
+   g_LcdQWait = 0;
+   #endif
+   #if defined(LCD_BUSY_TIMEOUT)
+   g_LcdBusyTicks = 0;
+   #endif
+  #endif
+
+  #if defined(LCD_BUSY_TIMEOUT)
+   g_LcdFault = 0;
+   g_LcdTimeouts = 0;
+  #endif
+
+   lcd_output_enable(0);
+   lcd_output_rs(0);
+   lcd_output_rw(0);
+
+ #if defined(LCD_SERIAL)
+   lcd_serial_burst(&g_LcdBus, 1);   // E low, backlight on
+ #elif defined(__PCB__)
+   set_tris_lcd(LCD_OUTPUT_MAP);
+ #else
+  #if defined(LCD_DATA_CONTIGUOUS)
+   lcd_data_drive();
+  #elif (defined(LCD_DATA4) && defined(LCD_DATA5) && defined(LCD_DATA6) && defined(LCD_DATA7))
+   #if defined(LCD_BUS8)
+   output_drive(LCD_DATA0);
+   output_drive(LCD_DATA1);
+   output_drive(LCD_DATA2);
+   output_drive(LCD_DATA3);
+   #endif
+   output_drive(LCD_DATA4);
+   output_drive(LCD_DATA5);
+   output_drive(LCD_DATA6);
+   output_drive(LCD_DATA7);
+  #else
+   lcdtris.data = 0x0;
+  #endif
+   lcd_enable_tris();
+   lcd_rs_tris();
+   lcd_rw_tris();
+ #endif
+    
+  #if defined(LCD_INIT_ASYNC)
+   // lcd_task() sends the reset nibbles, then the init string from the queue
+   g_LcdInitWait = LCD_INIT_TICKS(15);    // set first, the tick may be running
+   g_LcdInitStep = 4;
+   for(i=0;i<=3;++i)
+      lcd_send_byte(0,LCD_INIT_STRING[i]);
+  #else
+   delay_ms(15);
+   for(i=1;i<=3;++i)
+   {
+       lcd_send_nibble(LCD_RESET_NIBBLE);
+       delay_ms(5);
+   }
+   
+   lcd_send_nibble(LCD_RESET_LAST);
+   delay_ms(5);
+   for(i=0;i<=3;++i)
+      lcd_write_byte(0,LCD_INIT_STRING[i]);
+  #endif
+
+  #if !defined(LCD_MINIMAL)
+   // the init string cleared the display and homed the cursor
+   g_LcdX = 0;
+   g_LcdY = 0;
+   g_LcdAddr = 0;
+  #endif
+
+  #if defined(LCD_CGRAM_CACHE)
+   for(i=0;i<8;++i)
+      g_LcdCgramValid[i] = 0;
+  #endif
+
+  #if defined(LCD_SHADOW)
+   for(i=0;i<LCD_SHADOW_SIZE;++i)
+   {
+      g_LcdShadow[i] = ' ';
+      g_LcdDirty[i] = 0;
+   }
+   g_LcdAnyDirty = 0;
+  #endif
+}
+
+#if defined(LCD_MINIMAL)
+void lcd_gotoxy(unsigned int8 x, unsigned int8 y)
+{
+   unsigned int8 address;
+   
+   if(y!=1)
+      address=LCD_LINE_TWO;
+   else
+      address=0;
+     
+   address+=x-1;
+   lcd_send_byte(0,0x80|address);
+}
+#else
+void lcd_gotoxy(unsigned int8 x, unsigned int8 y)
+{
+   unsigned int8 address, row;
+
+   row = y - 1;
+   if (row >= LCD_ROWS)
+      row = 1;                 // as before, any other line is line two
+   address = LCD_ROW_ADDRESS[row] + x - 1;
+
+   g_LcdX = x - 1;
+   g_LcdY = row;
+   if (g_LcdX >= LCD_LINE_LENGTH)
+   {
+      // past the end of the row (the old lcd_gotoxy(21,1) way of reaching
+      // line three), use whichever row really holds that address
+      for (row = 0; row < LCD_ROWS; row++)
+      {
+         if ((unsigned int8)(address - LCD_ROW_ADDRESS[row]) < LCD_LINE_LENGTH)
+         {
+            g_LcdX = address - LCD_ROW_ADDRESS[row];
+            g_LcdY = row;
+         }
+      }
+   }
+
+  #if !defined(LCD_SHADOW)
+   if (address != g_LcdAddr)
+   {
+      lcd_send_byte(0,0x80|address);
+      g_LcdAddr = address;
+   }
+  #endif
+}
+#endif   //LCD_MINIMAL not defined
+
+#if defined(LCD_BUSY_TIMEOUT)
+// TRUE only if a module really answers: its address counter has to read
+// back two different set-address commands, busy flag clear.  one busy
+// flag sample proves nothing, floating or pulled down data lines read as
+// "not busy" too, and floating lines still hold the last nibble driven,
+// which neither address reads back as.  moves the address counter.
+int1 lcd_answers(void)
+{
+   lcd_write_byte(0, 0x80 | 0x15);
+   lcd_output_rs(0);
+   if (lcd_read_byte() != 0x15)
+      return(FALSE);
+   lcd_write_byte(0, 0x80 | 0x4A);
+   lcd_output_rs(0);
+   return(lcd_read_byte() == 0x4A);
+}
+
+// called every LCD_FAULT_RETRY characters while faulted.  a module that
+// answers again may have been power cycled, so it gets a full lcd_init().
+// with LCD_QUEUE the tick is masked throughout, as in lcd_getc(), so it
+// cannot be halfway through a byte or walk the queue lcd_init() resets.
+void lcd_recover(void)
+{
+  #if !defined(LCD_MINIMAL)
+   unsigned int8 x, y;
+  #else
+   unsigned int8 address;
+  #endif
+
+   g_LcdRetry = LCD_FAULT_RETRY;
+  #if defined(LCD_QUEUE)
+   while (!lcd_idle())
+      lcd_task_sync();
+   disable_interrupts(LCD_QUEUE_INT);
+   delay_us(LCD_EXEC_US_HOME);         // the last byte sent may still be running
+  #endif
+  #if defined(LCD_MINIMAL)
+   lcd_output_rs(0);
+   address = lcd_read_byte() & 0x7F;   // to put the cursor back if it fails
+  #endif
+   if (lcd_answers())
+   {
+     #if !defined(LCD_MINIMAL)
+      x = g_LcdX;                      // carry on where the text was going
+      y = g_LcdY;
+      lcd_init();
+      g_LcdX = x;
+      g_LcdY = y;
+     #else
+      lcd_init();
+     #endif
+   }
+   else
+   {
+     #if !defined(LCD_MINIMAL)
+      g_LcdAddr = LCD_ADDR_UNKNOWN;    // the next character sets it again
+     #else
+      lcd_write_byte(0, 0x80 | address);
+     #endif
+   }
+  #if defined(LCD_QUEUE)
+   enable_interrupts(LCD_QUEUE_INT);
+  #endif
+}
+#endif
+
+void lcd_putc(char c)
+{
+  #if defined(LCD_BUSY_TIMEOUT)
+   int1 retry;
+
+   // with LCD_QUEUE a timeout in the tick re-arms g_LcdRetry
+   #if defined(LCD_QUEUE)
+   disable_interrupts(LCD_QUEUE_INT);
+   #endif
+   retry = (g_LcdFault && !--g_LcdRetry);
+   #if defined(LCD_QUEUE)
+   enable_interrupts(LCD_QUEUE_INT);
+   #endif
+   if (retry)
+      lcd_recover();
+  #endif
+
+   switch (c)
+   {
+      case '\a'   :  lcd_gotoxy(1,1);     break;
+
+     #if defined(LCD_SHADOW)
+      case '\f'   :  lcd_shadow_clear();
+     #else
+      case '\f'   :  lcd_send_byte(0,1);
+                    #if !defined(LCD_QUEUE) && !defined(LCD_WRITE_ONLY)
+                     delay_ms(2);
+                    #endif
+                    #if !defined(LCD_MINIMAL)
+                     g_LcdAddr = 0;
+                    #endif
+     #endif
+                    #if !defined(LCD_MINIMAL)
+                     g_LcdX = 0;
+                     g_LcdY = 0;
+                    #endif
+                     break;
+
+     #if defined(LCD_EXTENDED_NEWLINE)
+      case '\r'   :  lcd_gotoxy(1, g_LcdY+1);   break;
+      case '\n'   :
+         while (g_LcdX < LCD_LINE_LENGTH)
+         {
+            lcd_put_data(' ');
+         }
+         lcd_gotoxy(1, (g_LcdY+1 < LCD_ROWS) ? g_LcdY+2 : 1);
+         break;
+     #else
+      case '\n'   : lcd_gotoxy(1,2);        break;
+     #endif
+     
+     #if defined(LCD_MINIMAL)
+      case '\b'   : lcd_send_byte(0,0x10);  break;
+     #else
+      case '\b'   : if (g_LcdX)
+                       lcd_gotoxy(g_LcdX, g_LcdY+1);
+                    break;
+     #endif
+     
+     #if defined(LCD_EXTENDED_NEWLINE)
+      default     : 
+         if (g_LcdX < LCD_LINE_LENGTH)
+         {
+            lcd_put_data(c);
+         }
+         break;
+     #else
+      default     : lcd_put_data(c);        break;
+     #endif
+   }
+}
+ 
+#if (!defined(LCD_MINIMAL) && (defined(LCD_SHADOW) || !defined(LCD_WRITE_ONLY)))
+char lcd_getc(unsigned int8 x, unsigned int8 y)
+{
+   char value;
+
+   lcd_gotoxy(x,y);
+  #if defined(LCD_SHADOW)
+   value = g_LcdShadow[lcd_address_cell(lcd_cursor_address())];
+  #else
+   #if defined(LCD_QUEUE)
+   while (!lcd_idle())
+      lcd_task_sync();
+   disable_interrupts(LCD_QUEUE_INT);
+   #endif
+   #if defined(LCD_BUSY_TIMEOUT)
+   lcd_wait_ready();
+   #else
+   while ( bit_test(lcd_read_byte(),7) ); // wait until busy flag is low
+   #endif
+   lcd_output_rs(1);
+   value = lcd_read_byte();
+   lcd_output_rs(0);
+   g_LcdAddr = LCD_ADDR_UNKNOWN;     // the read moved the address counter
+   #if defined(LCD_QUEUE)
+   enable_interrupts(LCD_QUEUE_INT);
+   #endif
+  #endif
+   
+   return(value);
+}
+#endif
+
+#if defined(LCD_CGRAM_CACHE)
+// returns TRUE if slot which already holds ptr's glyph, otherwise records
+// it as the slot's new contents and returns FALSE
+int1 lcd_cgram_cached(unsigned int8 which, unsigned int8 *ptr)
+{
+   unsigned int8 i;
+   int1 same;
+
+   same = g_LcdCgramValid[which];
+   for(i=0; i<8; i++)
+   {
+      if (g_LcdCgram[which][i] != ptr[i])
+      {
+         g_LcdCgram[which][i] = ptr[i];
+         same = 0;
+      }
+   }
+   g_LcdCgramValid[which] = 1;
+   return(same);
+}
+#endif
+
+// write a custom character to the ram
+// which is 0-7 and specifies which character array we are modifying.
+// ptr points to an array of 8 bytes, where each byte is the next row of
+//    pixels.  only bits 0-4 are used.  the last row is the cursor row, and
+//    usually you will want to leave this byte 0x00.
+#if !defined(LCD_MINIMAL)
+void lcd_set_cgram_char(unsigned int8 which, unsigned int8 *ptr)
+{
+   unsigned int i;
+
+  #if defined(LCD_CGRAM_CACHE)
+   which &= 7;
+   if (lcd_cgram_cached(which, ptr))
+      return;
+  #endif
+
+   which <<= 3;
+   which &= 0x38;
+
+   lcd_send_byte(0, 0x40 | which);  //set cgram address
+
+   for(i=0; i<8; i++)
+   {
+      lcd_send_byte(1, *ptr++);
+   }
+
+   // the next character written moves the LCD back into DDRAM
+   g_LcdAddr = LCD_ADDR_UNKNOWN;
+}
+#endif
+
+#if defined(LCD_BARGRAPH)
+#ifndef LCD_BAR_CGRAM
+   #define LCD_BAR_CGRAM 4             // first of the 4 slots lcd_bar() uses
+#endif
+#define LCD_BAR_FULL   0xFF            // solid block in the character ROM
+
+// character for a cell with 1-4 of its 5 pixel columns lit, loading the
+// glyph into its CGRAM slot the first time it is needed
+unsigned int8 lcd_bar_glyph(unsigned int8 lit)
+{
+   unsigned int8 rows[8];
+   unsigned int8 i, pattern;
+
+   pattern = (0x1F << (5 - lit)) & 0x1F;
+   for(i=0; i<8; i++)
+      rows[i] = pattern;
+   lcd_set_cgram_char(LCD_BAR_CGRAM + lit - 1, rows);
+   return(LCD_BAR_CGRAM + lit - 1);
+}
+
+void lcd_bar(unsigned int8 x, unsigned int8 y, unsigned int8 width,
+             unsigned int8 level, unsigned int8 *last)
+{
+   unsigned int8 lit, from, to, px, cell;
+   char c;
+
+   // width*5 pixel columns, level 255 lights all of them
+   lit = ((unsigned int16)level * (width * 5) + 128) >> 8;
+   if (lit == *last)
+      return;
+   if (lit < *last)
+   {
+      from = lit;
+      to = *last;
+   }
+   else
+   {
+      from = *last;
+      to = lit;
+   }
+   *last = lit;
+
+   // only the cells covering pixel columns from..to-1 change
+   px = 0;
+   cell = 0;
+   while ((px + 5) <= from)
+   {
+      px += 5;
+      cell++;
+   }
+
+   lcd_gotoxy(x + cell, y);
+   while (px < to)
+   {
+      if (lit >= px + 5)
+         c = LCD_BAR_FULL;
+      else if (lit <= px)
+         c = ' ';
+      else
+         c = lcd_bar_glyph(lit - px);
+      lcd_put_data(c);                 // glyph codes 4-7 would be \a etc.
+      px += 5;
+   }
+}
+#endif
+
+#if defined(LCD_MARQUEE)
+#ifndef LCD_MARQUEE_GAP
+   #define LCD_MARQUEE_GAP 4           // spaces between the end and the start
+#endif
+#define LCD_DDRAM_LINE   40            // characters in each DDRAM line
+#define LCD_MQ_SHIFT_MAX (LCD_DDRAM_LINE - LCD_MARQUEE_GAP)
+
+char *g_LcdMqText[LCD_ROWS];           // 0 when the row does not scroll
+unsigned int8 g_LcdMqLen[LCD_ROWS];
+unsigned int8 g_LcdMqPos[LCD_ROWS];    // text index at the left edge
+int1 g_LcdMqShift;                     // scrolling with display-shift
+
+// characters before the text repeats
+unsigned int8 lcd_marquee_period(unsigned int8 row)
+{
+   if (g_LcdMqShift)
+      return(LCD_DDRAM_LINE);
+   if (g_LcdMqLen[row] > LCD_LINE_LENGTH)
+      return(g_LcdMqLen[row] + LCD_MARQUEE_GAP);
+   return(LCD_LINE_LENGTH);            // fits, never moves
+}
+
+// write width characters of row's text, from text index start on, to the
+// start of the row.  goes past the cursor tracking, as the DDRAM line is
+// wider than a row.
+void lcd_marquee_row(unsigned int8 row, unsigned int8 start, unsigned int8 width)
+{
+   unsigned int8 i, k, period, address;
+   char c;
+
+   period = lcd_marquee_period(row);
+   address = LCD_ROW_ADDRESS[row];
+  #if !defined(LCD_SHADOW)
+   lcd_send_byte(0, 0x80 | address);
+   g_LcdAddr = LCD_ADDR_UNKNOWN;
+  #endif
+   k = start;
+   for (i = 0; i < width; i++)
+   {
+      c = (k < g_LcdMqLen[row]) ? g_LcdMqText[row][k] : ' ';
+     #if defined(LCD_SHADOW)
+      lcd_shadow_write(lcd_address_cell(address + i), c);
+     #else
+      lcd_send_byte(1, c);
+     #endif
+      if (++k >= period)
+         k = 0;
+   }
+}
+
+// pick hardware or software scrolling for the rows now set up, and draw them
+void lcd_marquee_start(void)
+{
+   unsigned int8 row;
+
+   if (g_LcdMqShift)
+   {
+      lcd_send_byte(0, 0x02);          // return home, undoes the shift
+      g_LcdMqShift = 0;
+     #if !defined(LCD_SHADOW)
+      g_LcdAddr = LCD_ADDR_UNKNOWN;
+     #endif
+   }
+
+  #if (LCD_ROWS == 2)
+   if (g_LcdMqText[0] && g_LcdMqText[1]
+       && (g_LcdMqLen[0] <= LCD_MQ_SHIFT_MAX) && (g_LcdMqLen[1] <= LCD_MQ_SHIFT_MAX))
+   {
+      g_LcdMqShift = 1;
+      for (row = 0; row < 2; row++)
+      {
+         g_LcdMqPos[row] = 0;
+         lcd_marquee_row(row, 0, LCD_DDRAM_LINE);
+      }
+      return;
+   }
+  #endif
+
+   for (row = 0; row < LCD_ROWS; row++)
+   {
+      if (g_LcdMqText[row])
+         lcd_marquee_row(row, g_LcdMqPos[row], LCD_LINE_LENGTH);
+   }
+}
+
+void lcd_marquee(unsigned int8 y, char *text)
+{
+   unsigned int8 row, len;
+
+   row = y - 1;
+   len = 0;
+   while (text[len] && (len < 0xFF - LCD_MARQUEE_GAP))
+      len++;
+   g_LcdMqText[row] = text;
+   g_LcdMqLen[row] = len;
+   g_LcdMqPos[row] = 0;
+   lcd_marquee_start();
+}
+
+void lcd_marquee_stop(unsigned int8 y)
+{
+   g_LcdMqText[y - 1] = 0;
+   lcd_marquee_start();
+}
+
+void lcd_marquee_step(void)
+{
+   unsigned int8 row;
+
+   if (g_LcdMqShift)
+   {
+      lcd_send_byte(0, 0x18);          // shift the display left
+      return;
+   }
+
+   for (row = 0; row < LCD_ROWS; row++)
+   {
+      if (!g_LcdMqText[row] || (g_LcdMqLen[row] <= LCD_LINE_LENGTH))
+         continue;
+      if (++g_LcdMqPos[row] >= lcd_marquee_period(row))
+         g_LcdMqPos[row] = 0;
+      lcd_marquee_row(row, g_LcdMqPos[row], LCD_LINE_LENGTH);
+   }
+}
+#endif
+
+void lcd_cursor_on(int1 on)
+{
+   if (on)
+   {
+      lcd_send_byte(0,0x0F);           //turn LCD cursor ON
+   }
+   else
+   {
+      lcd_send_byte(0,0x0C);           //turn LCD cursor OFF
+   }
+}
+
+#endif
@@ -21,14 +21,51 @@
 #define LCD_DATA5      PIN_C4   // LCD Data line D5 connected to RC4
 #define LCD_DATA6      PIN_C5   // LCD Data line D6 connected to RC5
 #define LCD_DATA7      PIN_A5   // LCD Data line D7 connected to RA5
+#define LCD_MINIMAL             // Small 2 line driver, no getc/CGRAM
+#define LCD_WRITE_ONLY          // Timed writes, no busy flag read code
 
 // -------------------- Library Includes --------------------
 #include <main.h>
 #include <lcd.c>                // Include LCD driver for 4-bit operation
+#include <numfmt.c>             // Numbers without printf
+#include <page.h>               // ROM pages, switched without clearing
+#include <adcscan.c>            // adc_read(), acquisition time worked out
+
+// -------------------- LCD Pages --------------------
+// '#' cells are the numbers, drawn by the main loop.  The button
+// counters sit past column 16, as they always have.
+#define PAGE_ADC       0        // both readings
+#define PAGE_BUTTON1   1        // readings + button 1 counter on line 2
+#define PAGE_BUTTON2   2        // readings + button 2 counter on line 1
+
+#define TXT_HELLO      0
+#define TXT_THIS_IS    1
+
+const char PAGE_TEXT[2][14] =
+{
+   "Hello #######",
+   "This is #####"
+};
+
+const PAGE_ITEM PAGE_ITEMS[] =
+{
+   { 1, 1, 13, TXT_HELLO },     // PAGE_ADC
+   { 1, 2, 13, TXT_HELLO },
+   { 1, 1, 13, TXT_HELLO },     // PAGE_BUTTON1
+   { 1, 2, 13, TXT_HELLO },
+   {26, 2, 13, TXT_THIS_IS },
+   { 1, 1, 13, TXT_HELLO },     // PAGE_BUTTON2
+   { 1, 2, 13, TXT_HELLO },
+   {26, 1, 13, TXT_THIS_IS }
+};
+
+const unsigned int8 PAGE_START[4] = {0, 2, 5, 8};
+
+#include <page.c>
 
 // -------------------- Variable Declarations --------------------
-unsigned int value = 0;         // ADC result from channel AN0 (RV1)
-unsigned int value1 = 0;        // ADC result from channel AN1 (RV2)
+unsigned int16 value = 0;       // ADC result from channel AN0 (RV1), 0..1023
+unsigned int16 value1 = 0;      // ADC result from channel AN1 (RV2), 0..1023
 unsigned int val = 0;           // Counter for button 1 (RA3)
 unsigned int val1 = 0;          // Counter for button 2 (RA4)
 
@@ -37,45 +74,44 @@ void main()
 {
    // --- Configure ADC ports ---
    setup_adc_ports(sAN0 | sAN1);     // Enable analog inputs on AN0 and AN1
-   setup_adc(ADC_CLOCK_INTERNAL);    // Use internal ADC clock
+   adc_setup();                      // ADC clock from the 8 MHz system clock
 
    // --- Initialize LCD ---
    lcd_init();                       // Prepare LCD for use
+   page_show(PAGE_ADC);
 
    while(TRUE) 
    {
-      // --- Read first potentiometer (RV1) ---
-      set_adc_channel(0);            // Select channel AN0
-      delay_us(30);                  // Wait for acquisition
-      value = read_adc();            // Read 10-bit ADC value (01023)
-      
-      // --- Read second potentiometer (RV2) ---
-      set_adc_channel(1);            // Select channel AN1
-      delay_us(30);
-      value1 = read_adc();
+      // --- Read both potentiometers (RV1 on AN0, RV2 on AN1) ---
+      value = adc_read(0);
+      value1 = adc_read(1);
 
       // --- Display both ADC readings ---
-      lcd_gotoxy(1, 1);              // Cursor: line 1, column 1
-      printf(lcd_putc, "Hello %u    ", value);   // Print first ADC value
+      lcd_gotoxy(7, 1);              // Cursor: after "Hello " on line 1
+      fmt_puts(lcd_putc, fmt_u16(value, 1));
+      lcd_putc("   ");
 	 
-      lcd_gotoxy(1, 2);              // Cursor: line 2, column 1
-      printf(lcd_putc, "Hello %u    ", value1);  // Print second ADC value
+      lcd_gotoxy(7, 2);              // Cursor: after "Hello " on line 2
+      fmt_puts(lcd_putc, fmt_u16(value1, 1));
+      lcd_putc("   ");
 
       // --- Button 1 (RA3): show counter on line 2 ---
       if (input(PIN_A3)) 
       {
-         printf(lcd_putc, "\f");     // Clear LCD
-         lcd_gotoxy(26, 2);          // Move cursor (position wraps around)
-         printf(lcd_putc, "This is %u  ", val);
+         page_show(PAGE_BUTTON1);    // Only the button 2 text is blanked
+         lcd_gotoxy(34, 2);          // After "This is " (past column 16)
+         fmt_puts(lcd_putc, fmt_u8(val, 1));
+         lcd_putc("  ");
          val++;                      // Increment counter
       }
       
       // --- Button 2 (RA4): show counter on line 1 ---
       if (input(PIN_A4)) 
       {
-         printf(lcd_putc, "\f");     
-         lcd_gotoxy(26, 1);          
-         printf(lcd_putc, "This is %u  ", val1);
+         page_show(PAGE_BUTTON2);
+         lcd_gotoxy(34, 1);
+         fmt_puts(lcd_putc, fmt_u8(val1, 1));
+         lcd_putc("  ");
          val1++;
       }
    }
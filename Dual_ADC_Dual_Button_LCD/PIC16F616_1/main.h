@@ -1,5 +1,5 @@
 #include <16F616.h>
-#device ADC=8
+#device ADC=10
 
 #FUSES PUT                   	//Power Up Timer
 #FUSES BROWNOUT              	//Reset when brownout detected
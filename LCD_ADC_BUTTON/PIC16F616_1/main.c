@@ -5,48 +5,47 @@
 #define LCD_DATA5 PIN_C4
 #define LCD_DATA6 PIN_C5
 #define LCD_DATA7 PIN_A5
+#define LCD_MINIMAL
+#define LCD_WRITE_ONLY
 
 #include <main.h>
 #include <lcd.c>
+#include <numfmt.c>
+#include <adcscan.c>
 
-unsigned int value = 0;
-unsigned int value1 = 0;
+unsigned int16 value = 0;
+unsigned int16 value1 = 0;
 unsigned int val = 0;
 unsigned int val1 = 0;
 
 void main() {
    setup_adc_ports(sAN0, sAN1);
-   setup_adc(ADC_CLOCK_INTERNAL);
+   adc_setup();
 
    lcd_init();
 
    while(TRUE) {
-      set_adc_channel(0);		// Select the ADC channel
-      delay_us(30);			// Delay 30 uS
-      value = read_adc();		// Call the ADC conversion function
-      
-      set_adc_channel(1);		// Select the ADC channel
-      delay_us(30);			// Delay 30 uS
-      value1 = read_adc();		// Call the ADC conversion function
+      value = adc_read(0);		// Select AN0, acquire and convert
+      value1 = adc_read(1);		// Select AN1, acquire and convert
       
       lcd_gotoxy(1, 1);			// Set the cursor at position 1,1 in the LCD
-      printf(lcd_putc, "Hello %u    ", value);	
+      lcd_putc("Hello "); fmt_puts(lcd_putc, fmt_u16(value, 1)); lcd_putc("   ");	
 	 
       lcd_gotoxy(1, 2);		
-      printf(lcd_putc, "Hello %u    ", value1);	
+      lcd_putc("Hello "); fmt_puts(lcd_putc, fmt_u16(value1, 1)); lcd_putc("   ");	
 
       
       if(input(Pin_a3)) {
-	 printf(lcd_putc, "\f");
+	 lcd_putc('\f');
 	 lcd_gotoxy(26, 2);
-	 printf(lcd_putc, "This is %u  ", val);
+	 lcd_putc("This is "); fmt_puts(lcd_putc, fmt_u8(val, 1)); lcd_putc("  ");
 	 val++;
       }
       
       if(input(Pin_a4)) {
-	 printf(lcd_putc, "\f");
+	 lcd_putc('\f');
 	 lcd_gotoxy(26, 1);
-	 printf(lcd_putc, "This is %u  ", val1);
+	 lcd_putc("This is "); fmt_puts(lcd_putc, fmt_u8(val1, 1)); lcd_putc("  ");
 	 val1++;
       }
    }
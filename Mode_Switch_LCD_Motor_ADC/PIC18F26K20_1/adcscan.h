@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+////                            ADCSCAN.H                                  ////
+////         Resolution and filter codes for the ADC module                ////
+////                                                                       ////
+////  ADC_BITS is the width #device ADC= gives read_adc(), from            ////
+////  getenv("ADC_RESOLUTION").  Thresholds and outputs that were written  ////
+////  for ADC=8 carry over with shifts worked out at compile time, so no   ////
+////  division or multiply is needed at run time:                          ////
+////                                                                       ////
+////     ADC_FROM8(v)      Lowest reading that ADC=8 would have read as v. ////
+////                       Use it for x < v and x >= v.                    ////
+////     ADC_FROM8_MAX(v)  Highest reading that ADC=8 would have read as   ////
+////                       v.  Use it for x > v and x <= v.                ////
+////     ADC_TO8(x)        x as ADC=8 would have read it, for 8 LEDs on a  ////
+////                       port, lcd_bar() levels and the like.            ////
+////                                                                       ////
+////  These are exact: ADC=8 reads the top 8 bits of the same conversion,  ////
+////  so x < ADC_FROM8(75) holds for the same inputs as x < 75 did under   ////
+////  ADC=8.  An ADC_FILTER_OVERSAMPLE(n) channel has n more bits, shift   ////
+////  by n as well.                                                        ////
+////                                                                       ////
+////  The cost of ADC=10 over ADC=8 is not measured: every listing in the  ////
+////  tree was built at ADC=8 and there is no CCS build at 10 yet.  The    ////
+////  ADC=8 listings give read_adc() itself, after the conversion: GO, a   ////
+////  two instruction poll and one ADRESH move, 5 cycles in 10 bytes on    ////
+////  PIC18 (ScaledProduct's Debug.lst) and 5 cycles in 5 words on the     ////
+////  PIC16F616 (LCD_ADC_BUTTON's).  Counted by hand on top of that, per   ////
+////  reading:                                                             ////
+////     read_adc()           +2 cycles (ADRESL as well as ADRESH); the    ////
+////                          conversion itself is the same 11 TAD         ////
+////     adc_scan_isr()       +4 cycles storing and filtering two bytes    ////
+////     compare to constant  +4 cycles                                    ////
+////     ADC_TO8(x)           ~8 cycles, two 16 bit shifts                 ////
+////     fmt_u16(x, 4)        up to ~600 cycles more than fmt_u8(x, 3)     ////
+////                          (18 16 bit ROM table steps for 999, against  ////
+////                          10 8 bit steps for 199)                      ////
+////                                                                       ////
+////  With ADC_SCAN_FILTERED defined, include this file, then list one     ////
+////  filter per channel, in the same order as ADC_SCAN_LIST, then include ////
+////  adcscan.c:                                                           ////
+////                                                                       ////
+////     const unsigned int8 ADC_SCAN_FILTER[ADC_SCAN_COUNT] =             ////
+////        {ADC_FILTER_NONE, ADC_FILTER_EMA(3), ADC_FILTER_BOX(2), ...};  ////
+////                                                                       ////
+////     ADC_FILTER_NONE           The conversion as it is.                ////
+////     ADC_FILTER_OVERSAMPLE(n)  4^n conversions back to back, summed    ////
+////                               and shifted right n: n more bits,       ////
+////                               n = 1..3.  Needs about 1 LSB of noise   ////
+////                               on the input, and ADC_SCAN_TYPE wide    ////
+////                               enough for the extra bits.  Without     ////
+////                               ACQT each repeat first waits 2 TAD      ////
+////                               and the acquisition time.               ////
+////     ADC_FILTER_EMA(k)         Moving average, y += (x - y) / 2^k,     ////
+////                               kept as y * 2^k in 16 bits, so k = 1..6 ////
+////                               for ADC=10, 1..8 for ADC=8.             ////
+////     ADC_FILTER_BOX(k)         Mean of the last 2^k scans, k = 1..4.   ////
+////                               Needs ADC_SCAN_BOX_SIZE, the sum of     ////
+////                               2^k over the boxcar channels.  The      ////
+////                               filter table does not compile           ////
+////                               without it.                             ////
+////                                                                       ////
+////  ADC_FILTER_MEDIAN(n) can be or'ed onto any of the above.  It passes  ////
+////  on the median of the last n scans, n = 3 or 5, before the EMA or     ////
+////  boxcar (after an OVERSAMPLE sum), so a spike of up to (n - 1) / 2    ////
+////  scans never gets through, where an average would only shrink it.     ////
+////  It lags a step by (n - 1) / 2 scans.  Needs ADC_SCAN_MEDIAN_SIZE,    ////
+////  the sum of n - 1 over the median channels:                           ////
+////                                                                       ////
+////     ADC_FILTER_MEDIAN(3) | ADC_FILTER_EMA(2)                          ////
+////                                                                       ////
+////  The filters are integer only.  Their cost is not measured: there     ////
+////  is no CCS build of this code yet.  Counted by hand from the C for    ////
+////  PIC18, on top of the ~45 cycles (also counted) of adc_scan_isr(),    ////
+////  for one channel:                                                     ////
+////     EMA(k)          ~30 + 4k cycles                                   ////
+////     BOX(k)          ~50 + 4k cycles                                   ////
+////     OVERSAMPLE(n)   ~20 cycles for each extra conversion, ~10 + 4n    ////
+////                     for the last.  The pass also gets 4^n - 1         ////
+////                     conversions longer.                               ////
+////     MEDIAN(3)       ~130 cycles, MEDIAN(5) ~250: 3 and 7 exchanges    ////
+////                     of ~20 cycles, plus the history loads and         ////
+////                     stores.  The network has no loops and no          ////
+////                     branches on the values in the C, so it should     ////
+////                     cost the same on every reading, but no listing    ////
+////                     confirms that yet.                                ////
+////  Define ADC_SCAN_PROFILE_PIN to measure them on a scope.              ////
+////                                                                       ////
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __ADCSCAN_H__
+#define __ADCSCAN_H__
+
+#ifndef ADC_BITS
+   #define ADC_BITS   getenv("ADC_RESOLUTION")
+#endif
+
+#define ADC_FROM8(v)       ((unsigned int16)(v) << (ADC_BITS - 8))
+#define ADC_FROM8_MAX(v)   (ADC_FROM8((v) + 1) - 1)
+#define ADC_TO8(x)         ((unsigned int8)((x) >> (ADC_BITS - 8)))
+
+#define ADC_FILTER_NONE            0x00
+#define ADC_FILTER_OVERSAMPLE(n)   (0x10 | (n))
+#define ADC_FILTER_EMA(k)          (0x20 | (k))
+// Refers to ADC_SCAN_BOX_SIZE so that a boxcar channel without the
+// ring pool is a compile error rather than an unfiltered channel.
+#define ADC_FILTER_BOX(k)          (0x30 | (k) | (ADC_SCAN_BOX_SIZE & 0))
+#define ADC_FILTER_MEDIAN(n)       (((n) - 1) << 5)     // 0x40 or 0x80
+
+#endif
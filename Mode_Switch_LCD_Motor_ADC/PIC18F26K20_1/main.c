@@ -8,7 +8,49 @@
 #define LCD_DATA5      PIN_C5
 #define LCD_DATA6      PIN_C6
 #define LCD_DATA7      PIN_C7
+#define LCD_ROWS       4         // 20x4 module
+#define LCD_BARGRAPH              // lcd_bar() for the pot reading
+#define LCD_BUSY_TIMEOUT          // RA1-RA4 mode switches work without the LCD
 #include <lcd.c>
+#include <page.h>
+#include <adcscan.c>               // adc_read() for the pot on AN0
+
+/* ===================== LCD Pages (20x4) =========================
+   One page per mode, the static text lives in ROM.  '#' cells are
+   drawn by the mode itself.
+   ================================================================ */
+#define PAGE_POT       0
+#define PAGE_CCW       1
+#define PAGE_CW        2
+#define PAGE_KNIGHT    3
+
+#define TXT_POT        0
+#define TXT_POT_BAR    1
+#define TXT_CCW        2
+#define TXT_CW         3
+#define TXT_KNIGHT     4
+
+const char PAGE_TEXT[5][21] =
+{
+    "Pot Value = #####",
+    "####################",
+    "Motor Anti-Clockwise",
+    "Motor Clockwise",
+    "Knight Rider"
+};
+
+const PAGE_ITEM PAGE_ITEMS[] =
+{
+    { 1, 1, 17, TXT_POT     },    // PAGE_POT
+    { 1, 2, 20, TXT_POT_BAR },
+    { 1, 2, 20, TXT_CCW     },    // PAGE_CCW
+    { 1, 3, 15, TXT_CW      },    // PAGE_CW
+    { 1, 4, 12, TXT_KNIGHT  }     // PAGE_KNIGHT
+};
+
+const unsigned int8 PAGE_START[5] = {0, 2, 3, 4, 5};
+
+#include <page.c>
 
 /* ======================= Globals ================================
    switches     : stores masked switch states from PORTA
@@ -18,19 +60,19 @@
 unsigned int switches;
 unsigned int mode_led_display = 0, mode_motor_ccw = 0, mode_motor_cw = 0, mode_knight = 0;
 unsigned int led_pattern[8] = {0x10,0x20,0x40,0x80,0x40,0x20,0x10,0x00};
+unsigned int pot_bar = 0;              // pixel columns lit in the pot bar
 
 /* ===================== Function Prototypes ====================== */
 void display_pot_value(void);          // Mode 1: Show ADC value on LCD
 void motor_anticlockwise_mode(void);   // Mode 2: Drive motor anti-clockwise
 void motor_clockwise_mode(void);       // Mode 3: Drive motor clockwise
 void knight_rider_mode(void);          // Mode 4: LED sweep controlled by pot
-unsigned int read_pot_value(void);     // Helper: Read potentiometer value
 
 /* ============================ MAIN ============================== */
 void main()
 {
     setup_adc_ports(sAN0);                        // Potentiometer on AN0
-    setup_adc(ADC_CLOCK_INTERNAL | ADC_TAD_MUL_0);
+    adc_setup();
     lcd_init();
     output_b(0x00);                               // Clear PORTB (LEDs/motor)
 
@@ -63,9 +105,7 @@ void knight_rider_mode(void)
 
     if (!mode_knight)
     {
-        printf(lcd_putc, "\f");
-        lcd_gotoxy(21, 2);
-        printf(lcd_putc, "Knight Rider");
+        page_show(PAGE_KNIGHT);
         mode_led_display = 0;
         mode_motor_ccw = 0;
         mode_motor_cw = 0;
@@ -74,7 +114,7 @@ void knight_rider_mode(void)
 
     for (step = 0; step < 8; step++)
     {
-        delay_value = read_pot_value();           // Variable speed from pot
+        delay_value = ADC_TO8(adc_read(0));       // Variable speed from pot, 0..255 ms
         output_b(led_pattern[step]);
         delay_ms(delay_value);
     }
@@ -90,9 +130,7 @@ void motor_clockwise_mode(void)
 
     if (!mode_motor_cw)
     {
-        printf(lcd_putc, "\f");
-        lcd_gotoxy(21, 1);
-        printf(lcd_putc, "Motor Clockwise");
+        page_show(PAGE_CW);
         mode_led_display = 0;
         mode_motor_ccw = 0;
         mode_motor_cw = 1;
@@ -113,9 +151,7 @@ void motor_anticlockwise_mode(void)
 
     if (!mode_motor_ccw)
     {
-        printf(lcd_putc, "\f");
-        lcd_gotoxy(1, 2);
-        printf(lcd_putc, "Motor Anti-Clockwise");
+        page_show(PAGE_CCW);
         mode_led_display = 0;
         mode_motor_ccw = 1;
         mode_motor_cw = 0;
@@ -127,34 +163,29 @@ void motor_anticlockwise_mode(void)
 }
 
 /* ========================= MODE 1 ===============================
-   Display current ADC (potentiometer) reading on LCD line 1.
+   Display current ADC (potentiometer) reading on LCD line 1,
+   with a 20 cell bar graph of it on line 2.
    Turns on LED1 to indicate active mode.
    =============================================================== */
 void display_pot_value(void)
 {
+    unsigned int16 pot;                           // 10 bit, 0..1023
+
     output_b(0x10);                               // Turn on LED1 (RB4)
 
     if (!mode_led_display)
     {
-        printf(lcd_putc, "\fPot Value = ");
+        page_show(PAGE_POT);
+        pot_bar = 0;                              // bar row was blanked
         mode_led_display = 1;
         mode_motor_ccw = 0;
         mode_motor_cw = 0;
         mode_knight = 0;
     }
 
+    pot = adc_read(0);
     lcd_gotoxy(13, 1);
-    printf(lcd_putc, "%u  ", read_pot_value());
-}
+    printf(lcd_putc, "%4lu ", pot);
 
-/* ======================== ADC HELPER ============================
-   Reads potentiometer voltage via AN0 and returns value (0255).
-   =============================================================== */
-unsigned int read_pot_value(void)
-{
-    unsigned int value;
-    set_adc_channel(0);
-    delay_us(20);
-    value = read_adc();                            // 8-bit ADC default in CCS
-    return value;
+    lcd_bar(1, 2, 20, ADC_TO8(pot), &pot_bar);    // only changed cells
 }
@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////
+////                            PAGE.H                                     ////
+////             Static screen pages in ROM, switched without a clear      ////
+////                                                                       ////
+////  A page is a list of text items.  Each item owns width cells at x,y   ////
+////  (upper left is 1,1, as lcd_gotoxy) and shows PAGE_TEXT[text], padded ////
+////  with spaces.  PAGE_FIELD characters (default '#') mark cells the     ////
+////  application fills in itself, such as a reading.                      ////
+////                                                                       ////
+////  Include this file, then define the tables below, then include        ////
+////  page.c (which also needs lcd.c):                                     ////
+////                                                                       ////
+////     const PAGE_ITEM PAGE_ITEMS[] = { ... };                           ////
+////                                    every page's items, page by page   ////
+////     const unsigned int8 PAGE_START[] = { ... };                       ////
+////                                    index of each page's first item,   ////
+////                                    plus one entry past the last item  ////
+////     const char PAGE_TEXT[][n] = { ... };                              ////
+////                                                                       ////
+////  page_show(n)  Switch to page n.  Both pages are compared cell by cell////
+////              from ROM and only cells that differ are written:         ////
+////              static text that changes, and PAGE_FIELD cells of the old////
+////              page that the new one does not use.  No clear command is ////
+////              sent, so nothing flickers.  Calling it for the page      ////
+////              already shown does nothing.  After lcd_init() the first  ////
+////              page only writes its non blank cells.                    ////
+////                                                                       ////
+////  page_puts(sink, t)  Send PAGE_TEXT[t] to any putc style function.    ////
+////                                                                       ////
+////  Anything drawn outside PAGE_FIELD cells is not known to the pages and////
+////  is left alone when switching.  Items of one page must not overlap.   ////
+////  For pages of changing values see screen.h.                           ////
+////                                                                       ////
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PAGE_H__
+#define __PAGE_H__
+
+typedef struct
+{
+   unsigned int8 x;           // first cell, 1 based
+   unsigned int8 y;           // row, 1 based
+   unsigned int8 width;       // cells owned
+   unsigned int8 text;        // PAGE_TEXT entry
+} PAGE_ITEM;
+
+#ifndef PAGE_FIELD
+   #define PAGE_FIELD   '#'
+#endif
+
+#define PAGE_NONE       0xFF
+
+#define page_puts(sink, t)  { unsigned int8 page_i; \
+   for (page_i = 0; PAGE_TEXT[t][page_i]; page_i++) sink(PAGE_TEXT[t][page_i]); }
+
+#endif
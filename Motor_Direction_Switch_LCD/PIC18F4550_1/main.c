@@ -26,6 +26,8 @@
 #define LCD_DATA5      PIN_D5
 #define LCD_DATA6      PIN_D6
 #define LCD_DATA7      PIN_D7
+#define LCD_ROWS       4         // 20x4 module
+#define LCD_BUSY_TIMEOUT          // SW1-SW3 still drive C0/C1 if the LCD stops answering
 
 // -------------------- Library Includes --------------------
 #include <main.h>
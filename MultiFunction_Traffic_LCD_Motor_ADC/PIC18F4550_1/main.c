@@ -25,19 +25,24 @@
 #define LCD_DATA5      PIN_D5
 #define LCD_DATA6      PIN_D6
 #define LCD_DATA7      PIN_D7
+#define LCD_ROWS       4         // 20x4 module
+#define LCD_BUSY_TIMEOUT          // both light sets still sequence on RB7 with no LCD
 
 // -------------------- Library Includes --------------------
 #include <main.h>
 #include <lcd.c>
 
+// -------------------- ADC Channels --------------------
+#define ADC_SCAN_COUNT 3                 // AN0..AN2, converted by adc_scan_now()
+const unsigned int8 ADC_SCAN_LIST[ADC_SCAN_COUNT] = {0, 1, 2};
+#include <adcscan.c>
+
 // -------------------- Function Prototypes --------------------
-void analogs(void);
 void printanalogs(void);
 void rotate(void);
 
 // -------------------- Global Variables --------------------
 unsigned int count;
-unsigned int value0, value1, value2;     // ADC readings for AN0AN2
 
 // Traffic light patterns
 unsigned int lights_A[9] = {0x01, 0x03, 0x04, 0x02, 0x01, 0x01, 0x01, 0x01};
@@ -68,7 +73,8 @@ void EXT2_isr(void) {
 void main() {
    // --- ADC and Timer Setup ---
    setup_adc_ports(AN0_TO_AN2);                    // Enable analog inputs AN0AN2
-   setup_adc(ADC_CLOCK_INTERNAL | ADC_TAD_MUL_0);  // Internal ADC clock
+   adc_setup();                                    // ADC clock from the system clock
+   adc_scan_init();
    setup_timer_2(T2_DIV_BY_16, 249, 15);           // Timer2: 2 ms overflow, 30 ms interrupt
       
    // --- Enable Interrupts ---
@@ -90,13 +96,13 @@ void main() {
 
       // --- RB4 Button: Read and print analog values on LCD ---
       if (input(PIN_B4)) {
-         analogs();
+         adc_scan_now();
          printanalogs();
       }
       
       // --- RB5 Button: Read analogs and control motor direction ---
       if (input(PIN_B5)) {
-         analogs();
+         adc_scan_now();
          rotate();
       }
       
@@ -128,20 +134,13 @@ void main() {
    }
 }
 
-// -------------------- ADC Reading Function --------------------
-void analogs(void) {
-   set_adc_channel(0); delay_us(30); value0 = read_adc();  // AN0
-   set_adc_channel(1); delay_us(30); value1 = read_adc();  // AN1
-   set_adc_channel(2); delay_us(30); value2 = read_adc();  // AN2
-}
-
 // -------------------- Motor Control Based on Analog Input --------------------
 void rotate(void) {
-   if (value0 < 120) {                   // Rotate forward
+   if (adc_scan_value(0) < ADC_FROM8(120)) {       // Rotate forward
       output_high(PIN_C0);
       output_low(PIN_C1);
    }
-   else if (value0 > 170) {              // Rotate reverse
+   else if (adc_scan_value(0) > ADC_FROM8_MAX(170)) {   // Rotate reverse
       output_high(PIN_C1);
       output_low(PIN_C0);
    }
@@ -154,11 +153,11 @@ void rotate(void) {
 // -------------------- LCD Display for ADC Values --------------------
 void printanalogs(void) {
    lcd_gotoxy(1, 1);
-   printf(lcd_putc, "Value0 = %3u", value0);
+   printf(lcd_putc, "Value0 = %4lu", adc_scan_value(0));
    
    lcd_gotoxy(1, 2);
-   printf(lcd_putc, "Value1 = %3u", value1);
+   printf(lcd_putc, "Value1 = %4lu", adc_scan_value(1));
    
    lcd_gotoxy(21, 1);
-   printf(lcd_putc, "Value2 = %3u", value2);
+   printf(lcd_putc, "Value2 = %4lu", adc_scan_value(2));
 }
@@ -1,5 +1,5 @@
 #include <18F4550.h>
-#device ADC=8
+#device ADC=10
 
 #FUSES FCMEN                 	//Fail-safe clock monitor enabled
 #FUSES IESO                  	//Internal External Switch Over mode enabled
@@ -0,0 +1,834 @@
+///////////////////////////////////////////////////////////////////////////////
+////                            ADCSCAN.C                                  ////
+////      ADC channels, read on demand or scanned from the ADC interrupt   ////
+////                                                                       ////
+////  adc_setup()  setup_adc() with the ADC clock and acquisition time     ////
+////               worked out below.  Call it after setup_adc_ports().     ////
+////                                                                       ////
+////  adc_read(ch)  Select channel ch, let it acquire, convert it and      ////
+////                return the result.  On parts with ACQT the ADC counts  ////
+////                the acquisition itself, otherwise it is a delay_us().  ////
+////                                                                       ////
+////  The acquisition time follows the datasheets' model:                  ////
+////                                                                       ////
+////     ADC_ACQ_NS = ADC_TAMP_NS + ADC_CHOLD_PF *                         ////
+////                  (ADC_RIC_RSS_OHMS + ADC_SOURCE_OHMS) * ln(2047)      ////
+////                                                                       ////
+////     ADC_SOURCE_OHMS   Source impedance.  Default 2500, a 10K pot at   ////
+////                       mid travel, which is its worst case.            ////
+////     ADC_CHOLD_PF      Hold capacitor.  Default 25.                    ////
+////     ADC_RIC_RSS_OHMS  Interconnect plus sampling switch.  Default     ////
+////                       3000.                                           ////
+////     ADC_TAMP_NS       Amplifier settling plus the temperature term at ////
+////                       85C.  Default 1400.                             ////
+////                                                                       ////
+////  That is 2.45 us with the defaults.  The ADC clock is the fastest     ////
+////  Fosc/n, from getenv("CLOCK"), that keeps TAD at or above             ////
+////  ADC_TAD_MIN_NS (default 1000 on the PIC18 parts, 1600 on the PIC16). ////
+////  Any of these can be defined before including this file.              ////
+////                                                                       ////
+////  For a list of channels the application also defines, before          ////
+////  including this file:                                                 ////
+////                                                                       ////
+////     #define ADC_SCAN_COUNT 5                                          ////
+////     const unsigned int8 ADC_SCAN_LIST[ADC_SCAN_COUNT] = {0,1,2,3,4};  ////
+////                                                                       ////
+////  adc_scan_init()  Reset the engine and select the first channel.      ////
+////                   Call it after adc_setup() and before the pacing     ////
+////                   interrupt is enabled.                               ////
+////                                                                       ////
+////  adc_scan_now()  Convert the whole list here and now with adc_read()  ////
+////                  and publish it as a scan, for applications that      ////
+////                  poll.  Filters and events apply, capture does not.   ////
+////                  Do not mix it with the interrupt driven scan.        ////
+////                                                                       ////
+////  adc_scan_start()  Start one scan of the list.  Does nothing while a  ////
+////                    scan is still running.  Call it from the timer     ////
+////                    interrupt that paces the scans.                    ////
+////                                                                       ////
+////  adc_scan_isr()  Call it from the #INT_AD handler.  It stores the     ////
+////                  result, selects the next channel and starts its      ////
+////                  conversion, then returns.                            ////
+////                                                                       ////
+////  adc_scan_busy()  TRUE while a scan is running.                       ////
+////                                                                       ////
+////  adc_scan_value(i)  i'th channel of the last complete scan, read      ////
+////                     again if a scan completes meanwhile.  Use         ////
+////                     adc_scan_read() when several results must come    ////
+////                     from the same scan.                               ////
+////                                                                       ////
+////  adc_scan_read(&snap)  Copy the last complete scan into an            ////
+////                        ADC_SCAN_SNAP: snap.value[], snap.scan (scan   ////
+////                        number) and snap.time (ADC_SCAN_CLOCK() when   ////
+////                        the scan started).  All of it is from one      ////
+////                        scan, and interrupts stay enabled.             ////
+////                                                                       ////
+////  adc_scan_seq()  Changes each time a scan completes, so the main      ////
+////                  loop can tell when there is something new to read.   ////
+////                                                                       ////
+////  Complete scans are published through two buffers.  The interrupt     ////
+////  fills one while the other is the published one, then flips them      ////
+////  and bumps an 8 bit sequence count.  adc_scan_read() and              ////
+////  adc_scan_value() copy from the published buffer and copy again if    ////
+////  the count moved meanwhile: after a flip the interrupt writes into    ////
+////  the buffer they were reading, so even one result could be half old   ////
+////  and half new (a 16 bit one), or from an unfinished scan.             ////
+////                                                                       ////
+////  On parts with ACQT (the PIC18F parts here) the ADC counts the        ////
+////  acquisition time itself and neither interrupt ever delays.  On       ////
+////  parts without it (the PIC16F616) each conversion waits for the       ////
+////  pacer instead: call adc_scan_start() once per channel, at least      ////
+////  ADC_ACQ_NS plus a conversion apart.  ADC_SCAN_FREE_RUN needs ACQT.   ////
+////                                                                       ////
+////  Options, defined before including this file:                         ////
+////                                                                       ////
+////   ADC_SCAN_TYPE  Type of a result.  Default unsigned int8 for         ////
+////                  #device ADC=8, unsigned int16 for ADC=10.            ////
+////                                                                       ////
+////   ADC_SCAN_CLOCK()  16 bit time stamp taken as each scan starts       ////
+////                     (as the last one ends without ACQT).              ////
+////                     Default get_timer1(), so Timer1 must be set up.   ////
+////                                                                       ////
+////   ADC_SCAN_FREE_RUN  A new scan starts as soon as the last one        ////
+////                      ends, so no pacing timer is needed.              ////
+////                      adc_scan_init() starts the first one.            ////
+////                                                                       ////
+////   ADC_SCAN_FILTERED  Each channel gets a filter from the application's////
+////                      ADC_SCAN_FILTER[] table, see adcscan.h.          ////
+////                                                                       ////
+////   ADC_SCAN_EVENTS  Each channel raises an event when its value (after ////
+////                    any filter) moves more than its deadband away from ////
+////                    the value at its last event.  The application      ////
+////                    lists the deadbands, in counts:                    ////
+////                                                                       ////
+////     const unsigned int8 ADC_SCAN_DEADBAND[ADC_SCAN_COUNT] = {2, ...}; ////
+////                                                                       ////
+////      adc_scan_changed(i)  TRUE once per event on the i'th channel,    ////
+////                           so display or motor code only runs when     ////
+////                           the input really moved.  The first scan     ////
+////                           raises one on every channel.  Each channel  ////
+////                           should be asked about from one place only.  ////
+////                                                                       ////
+////   ADC_SCAN_CAPTURE  Burst capture into RAM, for looking at noise,     ////
+////                     settling and ripple.  Samples are the raw         ////
+////                     conversions, one per captured channel per scan,   ////
+////                     so each channel's samples are exactly a scan      ////
+////                     apart and the main loop has no say in the         ////
+////                     timing.  The channels within one scan are only    ////
+////                     a conversion apart (acquisition plus 11 TAD),     ////
+////                     not a scan period, so they are neither sampled    ////
+////                     together nor evenly spread across the period.     ////
+////                     Only adc_scan_isr() captures.  The PIC16F616      ////
+////                     builds poll with adc_read(), and the part has     ////
+////                     128 bytes of RAM and no UART, so there is no      ////
+////                     capture there.                                    ////
+////                                                                       ////
+////      adc_scan_capture(mask)  Capture the list entries in mask (bit 0  ////
+////                              is the first) from the next scan on.     ////
+////      adc_scan_capture_busy()  TRUE until the capture is dumped.       ////
+////      adc_scan_capture_full()  TRUE when it is ready to dump.          ////
+////      adc_scan_dump()  Send it in binary over the #use rs232 stream,   ////
+////                       see the function for the format.  The main      ////
+////                       loop waits until it is sent: about 1.1 s for    ////
+////                       the 1K buffer at 9600 baud.                     ////
+////                       On a software UART the #use rs232 needs         ////
+////                       DISABLE_INTS, or each interrupt taken in a      ////
+////                       character stretches a bit and corrupts it.      ////
+////                       That holds every interrupt off for a whole      ////
+////                       character, 1.04 ms at 9600 baud, so a 128 us    ////
+////                       LCD_QUEUE tick (ADC5's) runs up to seven        ////
+////                       periods late and the ticks in between are       ////
+////                       lost: the LCD slows down during a dump.         ////
+////                                                                       ////
+////      ADC_SCAN_CAP_BYTES  Buffer size.  Default 1024 on parts with     ////
+////                          3K of RAM or more, 512 from 1.5K, else 32.   ////
+////      ADC_SCAN_PERIOD_US  Scan period, sent in the dump header so the  ////
+////                          host knows the sample rate.  Default 0.      ////
+////                                                                       ////
+////   ADC_SCAN_PROFILE_PIN  Driven high for the whole of adc_scan_isr(),  ////
+////                         so its cost can be read off a scope or the    ////
+////                         simulator.                                    ////
+////                                                                       ////
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __ADCSCAN_C__
+#define __ADCSCAN_C__
+
+#include <adcscan.h>
+
+#ifndef ADC_SCAN_TYPE
+ #if ADC_BITS > 8
+   #define ADC_SCAN_TYPE unsigned int16
+ #else
+   #define ADC_SCAN_TYPE unsigned int8
+ #endif
+#endif
+
+#ifndef ADC_SOURCE_OHMS
+   #define ADC_SOURCE_OHMS    2500
+#endif
+#ifndef ADC_CHOLD_PF
+   #define ADC_CHOLD_PF       25
+#endif
+#ifndef ADC_RIC_RSS_OHMS
+   #define ADC_RIC_RSS_OHMS   3000
+#endif
+#ifndef ADC_TAMP_NS
+   #define ADC_TAMP_NS        1400
+#endif
+#ifndef ADC_TAD_MIN_NS
+ #if getenv("BITS_PER_INSTRUCTION") == 14
+   #define ADC_TAD_MIN_NS     1600
+ #else
+   #define ADC_TAD_MIN_NS     1000
+ #endif
+#endif
+
+// ln(2047) = 7.624: the hold capacitor settles to 1/2 LSB of 10 bits.
+// In 32 bits, the product overflows 16.
+#define ADC_ACQ_NS   (ADC_TAMP_NS + ADC_CHOLD_PF * 7624L / 100 * \
+                      (ADC_RIC_RSS_OHMS + ADC_SOURCE_OHMS) / 10000)
+#define ADC_ACQ_US   ((ADC_ACQ_NS + 999) / 1000)
+
+#define ADC_FOSC_MHZ (getenv("CLOCK") / 1000000)
+#define ADC_TAD_DIV_MIN ((ADC_TAD_MIN_NS * ADC_FOSC_MHZ + 999) / 1000)
+
+#if ADC_TAD_DIV_MIN <= 2
+   #define ADC_TAD_CLOCK  ADC_CLOCK_DIV_2
+   #define ADC_TAD_NS     (2000 / ADC_FOSC_MHZ)
+#elif ADC_TAD_DIV_MIN <= 4
+   #define ADC_TAD_CLOCK  ADC_CLOCK_DIV_4
+   #define ADC_TAD_NS     (4000 / ADC_FOSC_MHZ)
+#elif ADC_TAD_DIV_MIN <= 8
+   #define ADC_TAD_CLOCK  ADC_CLOCK_DIV_8
+   #define ADC_TAD_NS     (8000 / ADC_FOSC_MHZ)
+#elif ADC_TAD_DIV_MIN <= 16
+   #define ADC_TAD_CLOCK  ADC_CLOCK_DIV_16
+   #define ADC_TAD_NS     (16000 / ADC_FOSC_MHZ)
+#elif ADC_TAD_DIV_MIN <= 32
+   #define ADC_TAD_CLOCK  ADC_CLOCK_DIV_32
+   #define ADC_TAD_NS     (32000 / ADC_FOSC_MHZ)
+#elif ADC_TAD_DIV_MIN <= 64
+   #define ADC_TAD_CLOCK  ADC_CLOCK_DIV_64
+   #define ADC_TAD_NS     (64000 / ADC_FOSC_MHZ)
+#else
+   #define ADC_TAD_CLOCK  ADC_CLOCK_INTERNAL
+   #define ADC_TAD_NS     2000             // the fastest the RC clock runs
+#endif
+
+#if defined(ADC_TAD_MUL_0)             // the part has ACQT
+ #define ADC_ACQ_TADS ((ADC_ACQ_NS + ADC_TAD_NS - 1) / ADC_TAD_NS)
+ #if ADC_ACQ_TADS <= 2
+   #define ADC_TAD_ACQ    ADC_TAD_MUL_2
+ #elif ADC_ACQ_TADS <= 4
+   #define ADC_TAD_ACQ    ADC_TAD_MUL_4
+ #elif ADC_ACQ_TADS <= 6
+   #define ADC_TAD_ACQ    ADC_TAD_MUL_6
+ #elif ADC_ACQ_TADS <= 8
+   #define ADC_TAD_ACQ    ADC_TAD_MUL_8
+ #elif ADC_ACQ_TADS <= 12
+   #define ADC_TAD_ACQ    ADC_TAD_MUL_12
+ #elif ADC_ACQ_TADS <= 16
+   #define ADC_TAD_ACQ    ADC_TAD_MUL_16
+ #elif ADC_ACQ_TADS <= 20
+   #define ADC_TAD_ACQ    ADC_TAD_MUL_20
+ #else
+   #error ADC_SOURCE_OHMS too high for ACQT, buffer the source
+ #endif
+ #define adc_setup()   setup_adc(ADC_TAD_CLOCK | ADC_TAD_ACQ)
+#else
+ #define adc_setup()   setup_adc(ADC_TAD_CLOCK)
+ #if defined(ADC_SCAN_FREE_RUN)
+   #error ADC_SCAN_FREE_RUN needs a part with ACQT
+ #endif
+#endif
+
+// Without ACQT a conversion is followed by 2 TAD before the hold
+// capacitor reconnects, then the acquisition time, before GO again.
+#define ADC_REPEAT_US   (ADC_ACQ_US + (2 * ADC_TAD_NS + 999) / 1000)
+
+ADC_SCAN_TYPE adc_read(unsigned int8 ch)
+{
+   set_adc_channel(ch);
+  #if !defined(ADC_TAD_MUL_0)
+   delay_us(ADC_ACQ_US);
+  #endif
+   return read_adc();                  // with ACQT the ADC waits itself
+}
+
+#if defined(ADC_SCAN_COUNT)
+
+#ifndef ADC_SCAN_CLOCK
+   #define ADC_SCAN_CLOCK() get_timer1()
+#endif
+
+typedef struct
+{
+   unsigned int16 scan;                // scan number, counts from 0
+   unsigned int16 time;                // ADC_SCAN_CLOCK() at the start
+   ADC_SCAN_TYPE value[ADC_SCAN_COUNT];
+} ADC_SCAN_SNAP;
+
+ADC_SCAN_SNAP g_AdcScanBuf[2];
+unsigned int8 g_AdcScanSeq;            // bit 0 is the published buffer
+unsigned int8 g_AdcScanWr;             // buffer the interrupt fills
+unsigned int16 g_AdcScanCount;
+unsigned int8 g_AdcScanIdx;            // list entry being converted
+int1 g_AdcScanBusy;
+int1 g_AdcScanStamp;                   // next start begins a scan
+
+#if defined(ADC_SCAN_FILTERED)
+unsigned int16 g_AdcFiltState[ADC_SCAN_COUNT];   // EMA y * 2^k, or BOX sum
+unsigned int16 g_AdcOsSum;             // OVERSAMPLE sum so far
+unsigned int8 g_AdcOsLeft;             // OVERSAMPLE conversions to go
+ #if defined(ADC_SCAN_BOX_SIZE)
+  #if ADC_SCAN_BOX_SIZE > 255
+   #error ADC_SCAN_BOX_SIZE over 255, the ring offsets are 8 bit
+  #endif
+ADC_SCAN_TYPE g_AdcBox[ADC_SCAN_BOX_SIZE];
+unsigned int8 g_AdcBoxBase[ADC_SCAN_COUNT];      // channel's ring in g_AdcBox
+unsigned int8 g_AdcBoxPos[ADC_SCAN_COUNT];       // next slot, 0..2^k-1
+ #endif
+ #if defined(ADC_SCAN_MEDIAN_SIZE)
+ADC_SCAN_TYPE g_AdcMed[ADC_SCAN_MEDIAN_SIZE];    // last n - 1, newest first
+unsigned int8 g_AdcMedBase[ADC_SCAN_COUNT];      // channel's history
+ #endif
+#endif
+
+#if defined(ADC_SCAN_EVENTS)
+ADC_SCAN_TYPE g_AdcEventRef[ADC_SCAN_COUNT];     // value at the last event
+unsigned int8 g_AdcEventSeq[ADC_SCAN_COUNT];     // bumped by the interrupt
+unsigned int8 g_AdcEventSeen[ADC_SCAN_COUNT];    // adc_scan_changed()'s copy
+#endif
+
+#if defined(ADC_SCAN_FILTERED) || defined(ADC_SCAN_EVENTS)
+int1 g_AdcScanFirst;                   // first scan, seeds the state
+#endif
+
+#if defined(ADC_SCAN_CAPTURE)
+ #ifndef ADC_SCAN_CAP_BYTES
+  #if getenv("RAM") >= 3072
+   #define ADC_SCAN_CAP_BYTES 1024
+  #elif getenv("RAM") >= 1536
+   #define ADC_SCAN_CAP_BYTES 512
+  #else
+   #define ADC_SCAN_CAP_BYTES 32
+  #endif
+ #endif
+ #ifndef ADC_SCAN_PERIOD_US
+   #define ADC_SCAN_PERIOD_US 0
+ #endif
+
+#define ADC_SCAN_CAP_SIZE    (ADC_SCAN_CAP_BYTES / sizeof(ADC_SCAN_TYPE))
+
+#define ADC_CAP_IDLE   0
+#define ADC_CAP_ARMED  1               // waiting for the next scan to start
+#define ADC_CAP_RUN    2
+#define ADC_CAP_FULL   3               // waiting for adc_scan_dump()
+
+ADC_SCAN_TYPE g_AdcCap[ADC_SCAN_CAP_SIZE];
+unsigned int16 g_AdcCapPos, g_AdcCapEnd;
+unsigned int8 g_AdcCapMask;            // list entries captured
+unsigned int8 g_AdcCapState;
+unsigned int8 g_AdcCapSum;             // dump check sum
+#endif
+
+#define adc_scan_busy()      (g_AdcScanBusy)
+#define adc_scan_seq()       (g_AdcScanSeq)
+
+void adc_scan_start(void)
+{
+   if (g_AdcScanBusy)
+      return;
+
+   g_AdcScanBusy = TRUE;
+   if (g_AdcScanStamp)
+   {
+      g_AdcScanBuf[g_AdcScanWr].time = ADC_SCAN_CLOCK();
+      g_AdcScanStamp = FALSE;
+   }
+   read_adc(ADC_START_ONLY);           // the channel is already selected
+}
+
+// Publish the filled buffer: it becomes the readers' one and the next
+// scan goes into the buffer they were reading.
+#if defined(ADC_SCAN_FILTERED) || defined(ADC_SCAN_EVENTS)
+ #define adc_scan_first_done()  g_AdcScanFirst = FALSE
+#else
+ #define adc_scan_first_done()
+#endif
+#define adc_scan_publish() \
+   { \
+      g_AdcScanBuf[g_AdcScanWr].scan = g_AdcScanCount++; \
+      g_AdcScanSeq++; \
+      g_AdcScanWr ^= 1; \
+      g_AdcScanStamp = TRUE; \
+      adc_scan_first_done(); \
+   }
+
+#if defined(ADC_SCAN_FILTERED)
+#if defined(ADC_SCAN_MEDIAN_SIZE)
+// Leave the smaller of a and b in a and the larger in b.  d = b - a is
+// kept only when it is negative.  The bit test should compile to a
+// skip over one instruction, the same cycles either way, so that every
+// exchange costs the same whatever the values; no listing of it has
+// been built to confirm that.  Values must be below 0x8000, which 10
+// bits plus OVERSAMPLE(3) is.
+#define adc_med_cx(a, b) \
+   { \
+      d = (signed int16)(b) - (signed int16)(a); \
+      m = 0; \
+      if (bit_test(d, 15)) \
+         m = 0xFF; \
+      d &= make16(m, m); \
+      a += d; \
+      b -= d; \
+   }
+
+// Median of x and the last n - 1 values of list entry i, from a fixed
+// sorting network: 3 exchanges for MEDIAN(3), 7 for MEDIAN(5).  The
+// first scan seeds the history with x.
+ADC_SCAN_TYPE adc_scan_median(unsigned int8 i, unsigned int8 f,
+                              ADC_SCAN_TYPE x)
+{
+   unsigned int8 b, m;
+   signed int16 d;
+   ADC_SCAN_TYPE v0, v1, v2, v3, v4;
+
+   b = g_AdcMedBase[i];
+   v0 = x;
+   v1 = g_AdcMed[b];
+   v2 = g_AdcMed[b + 1];
+   if (f & ADC_FILTER_MEDIAN(5))
+   {
+      v3 = g_AdcMed[b + 2];
+      v4 = g_AdcMed[b + 3];
+   }
+   if (g_AdcScanFirst)
+   {
+      v1 = x;
+      v2 = x;
+      v3 = x;
+      v4 = x;
+   }
+
+   // the history moves down one and x becomes the newest
+   g_AdcMed[b] = x;
+   g_AdcMed[b + 1] = v1;
+
+   if (f & ADC_FILTER_MEDIAN(5))
+   {
+      g_AdcMed[b + 2] = v2;
+      g_AdcMed[b + 3] = v3;
+
+      adc_med_cx(v0, v1);
+      adc_med_cx(v3, v4);
+      adc_med_cx(v0, v3);
+      adc_med_cx(v1, v4);
+      adc_med_cx(v1, v2);
+      adc_med_cx(v2, v3);
+      adc_med_cx(v1, v2);
+      return v2;
+   }
+
+   adc_med_cx(v0, v1);
+   adc_med_cx(v1, v2);
+   adc_med_cx(v0, v1);
+   return v1;
+}
+#endif
+
+// Filter x for list entry i.  Called from adc_scan_isr(), or
+// adc_scan_now() in applications that poll.  The
+// first scan seeds the EMA and boxcar state with x, so they do not
+// ramp up from 0.
+ADC_SCAN_TYPE adc_scan_filter(unsigned int8 i, ADC_SCAN_TYPE x)
+{
+   unsigned int8 f, k;
+   unsigned int16 s;
+  #if defined(ADC_SCAN_BOX_SIZE)
+   unsigned int8 slot, n;
+  #endif
+
+   f = ADC_SCAN_FILTER[i];
+   k = f & 0x0F;
+   s = g_AdcFiltState[i];
+
+   if ((f & 0x30) == ADC_FILTER_OVERSAMPLE(0))   // last conversion of the run
+      x = (g_AdcOsSum + x) >> k;
+
+  #if defined(ADC_SCAN_MEDIAN_SIZE)
+   if (f & 0xC0)
+      x = adc_scan_median(i, f, x);
+  #endif
+
+   switch (f & 0x30)
+   {
+      case ADC_FILTER_EMA(0):
+         if (g_AdcScanFirst)
+            s = (unsigned int16)x << k;
+         else
+            s += x - (s >> k);
+         g_AdcFiltState[i] = s;
+         return (s + (((unsigned int16)1 << k) >> 1)) >> k;    // rounded
+
+     #if defined(ADC_SCAN_BOX_SIZE)
+      case ADC_FILTER_BOX(0):
+         n = 1 << k;
+         slot = g_AdcBoxBase[i] + g_AdcBoxPos[i];
+         if (g_AdcScanFirst)
+         {
+            for (slot = 0; slot < n; slot++)
+               g_AdcBox[g_AdcBoxBase[i] + slot] = x;
+            s = (unsigned int16)x << k;
+         }
+         else
+         {
+            s += x;
+            s -= g_AdcBox[slot];
+            g_AdcBox[slot] = x;
+            g_AdcBoxPos[i] = (g_AdcBoxPos[i] + 1) & (n - 1);
+         }
+         g_AdcFiltState[i] = s;
+         return s >> k;
+     #endif
+   }
+   return x;
+}
+
+// Called when list entry i is selected: an OVERSAMPLE channel
+// converts 4^n times before moving on.
+#define adc_scan_os_begin(i) \
+   { \
+      g_AdcOsSum = 0; \
+      g_AdcOsLeft = 1; \
+      if ((ADC_SCAN_FILTER[i] & 0x30) == ADC_FILTER_OVERSAMPLE(0)) \
+         g_AdcOsLeft <<= (ADC_SCAN_FILTER[i] & 0x0F) * 2; \
+   }
+#endif
+
+#if defined(ADC_SCAN_EVENTS)
+// Raise an event for list entry i when x is more than its deadband
+// away from the value of the last event.  Called from adc_scan_isr(),
+// or adc_scan_now() in applications that poll.
+void adc_scan_event(unsigned int8 i, ADC_SCAN_TYPE x)
+{
+   ADC_SCAN_TYPE d;
+
+   if (x > g_AdcEventRef[i])
+      d = x - g_AdcEventRef[i];
+   else
+      d = g_AdcEventRef[i] - x;
+
+   if (g_AdcScanFirst || (d > ADC_SCAN_DEADBAND[i]))
+   {
+      g_AdcEventRef[i] = x;
+      g_AdcEventSeq[i]++;
+   }
+}
+#endif
+
+void adc_scan_isr(void)
+{
+   ADC_SCAN_TYPE x;
+
+  #if defined(ADC_SCAN_PROFILE_PIN)
+   output_high(ADC_SCAN_PROFILE_PIN);
+  #endif
+
+   x = read_adc(ADC_READ_ONLY);
+
+  #if defined(ADC_SCAN_FILTERED)
+   if (g_AdcOsLeft > 1)
+   {
+      g_AdcOsSum += x;
+      g_AdcOsLeft--;
+     #if defined(ADC_TAD_MUL_0)
+      read_adc(ADC_START_ONLY);        // same channel again
+     #else
+      g_AdcScanBusy = FALSE;           // again on the next pacer tick
+     #endif
+     #if defined(ADC_SCAN_PROFILE_PIN)
+      output_low(ADC_SCAN_PROFILE_PIN);
+     #endif
+      return;
+   }
+  #endif
+
+  #if defined(ADC_SCAN_CAPTURE)
+   if ((g_AdcCapState == ADC_CAP_RUN) && bit_test(g_AdcCapMask, g_AdcScanIdx))
+   {
+      g_AdcCap[g_AdcCapPos] = x;       // the conversion, before any filter
+      if (++g_AdcCapPos >= g_AdcCapEnd)
+         g_AdcCapState = ADC_CAP_FULL;
+   }
+  #endif
+
+  #if defined(ADC_SCAN_FILTERED)
+   x = adc_scan_filter(g_AdcScanIdx, x);
+  #endif
+
+  #if defined(ADC_SCAN_EVENTS)
+   adc_scan_event(g_AdcScanIdx, x);
+  #endif
+
+   g_AdcScanBuf[g_AdcScanWr].value[g_AdcScanIdx] = x;
+
+   if (++g_AdcScanIdx >= ADC_SCAN_COUNT)
+   {
+      g_AdcScanIdx = 0;
+      adc_scan_publish();
+
+     #if defined(ADC_SCAN_CAPTURE)
+      if (g_AdcCapState == ADC_CAP_ARMED)
+         g_AdcCapState = ADC_CAP_RUN;  // capture from the next scan on
+     #endif
+
+     #if defined(ADC_SCAN_FREE_RUN)
+      g_AdcScanBuf[g_AdcScanWr].time = ADC_SCAN_CLOCK();
+     #endif
+   }
+
+   // The next channel is selected now, so it is acquiring from here on.
+   // GO then waits ADC_TAD_MUL_n more before converting, or without
+   // ACQT the pacer sets GO a tick later.
+   set_adc_channel(ADC_SCAN_LIST[g_AdcScanIdx]);
+  #if defined(ADC_SCAN_FILTERED)
+   adc_scan_os_begin(g_AdcScanIdx);
+  #endif
+
+  #if defined(ADC_SCAN_FREE_RUN)
+   read_adc(ADC_START_ONLY);
+  #elif !defined(ADC_TAD_MUL_0)
+   g_AdcScanBusy = FALSE;
+  #else
+   if (g_AdcScanIdx)
+      read_adc(ADC_START_ONLY);
+   else
+      g_AdcScanBusy = FALSE;           // scan complete, wait for the pacer
+  #endif
+
+  #if defined(ADC_SCAN_PROFILE_PIN)
+   output_low(ADC_SCAN_PROFILE_PIN);
+  #endif
+}
+
+void adc_scan_read(ADC_SCAN_SNAP *snap)
+{
+   unsigned int8 seq, i;
+   ADC_SCAN_SNAP *buf;
+
+   do
+   {
+      seq = g_AdcScanSeq;
+      buf = &g_AdcScanBuf[seq & 1];
+      snap->scan = buf->scan;
+      snap->time = buf->time;
+      for (i = 0; i < ADC_SCAN_COUNT; i++)
+         snap->value[i] = buf->value[i];
+   } while (seq != g_AdcScanSeq);      // a scan completed, copy again
+}
+
+ADC_SCAN_TYPE adc_scan_value(unsigned int8 i)
+{
+   unsigned int8 seq;
+   ADC_SCAN_TYPE value;
+
+   do
+   {
+      seq = g_AdcScanSeq;
+      value = g_AdcScanBuf[seq & 1].value[i];
+   } while (seq != g_AdcScanSeq);      // a scan completed, read again
+   return(value);
+}
+
+void adc_scan_now(void)
+{
+   ADC_SCAN_TYPE x;
+
+   g_AdcScanBuf[g_AdcScanWr].time = ADC_SCAN_CLOCK();
+
+   for (g_AdcScanIdx = 0; g_AdcScanIdx < ADC_SCAN_COUNT; g_AdcScanIdx++)
+   {
+      x = adc_read(ADC_SCAN_LIST[g_AdcScanIdx]);
+     #if defined(ADC_SCAN_FILTERED)
+      adc_scan_os_begin(g_AdcScanIdx);
+      while (g_AdcOsLeft > 1)
+      {
+         g_AdcOsSum += x;
+         g_AdcOsLeft--;
+        #if !defined(ADC_TAD_MUL_0)
+         delay_us(ADC_REPEAT_US);      // ACQT would wait by itself
+        #endif
+         x = read_adc();
+      }
+      x = adc_scan_filter(g_AdcScanIdx, x);
+     #endif
+     #if defined(ADC_SCAN_EVENTS)
+      adc_scan_event(g_AdcScanIdx, x);
+     #endif
+      g_AdcScanBuf[g_AdcScanWr].value[g_AdcScanIdx] = x;
+   }
+
+   g_AdcScanIdx = 0;
+   adc_scan_publish();
+}
+
+#if defined(ADC_SCAN_EVENTS)
+// TRUE once for each event on list entry i.  Only one part of the
+// application should ask about a given channel.
+int1 adc_scan_changed(unsigned int8 i)
+{
+   unsigned int8 seq;
+
+   seq = g_AdcEventSeq[i];
+   if (seq == g_AdcEventSeen[i])
+      return FALSE;
+
+   g_AdcEventSeen[i] = seq;
+   return TRUE;
+}
+#endif
+
+#if defined(ADC_SCAN_CAPTURE)
+#define adc_scan_capture_busy()   (g_AdcCapState != ADC_CAP_IDLE)
+#define adc_scan_capture_full()   (g_AdcCapState == ADC_CAP_FULL)
+
+// Capture the list entries in mask (bit 0 is the first entry) from the
+// next scan on, until the buffer is full.  Ignored while a capture is
+// still running or waiting to be dumped.
+void adc_scan_capture(unsigned int8 mask)
+{
+   unsigned int8 i, n;
+
+   if (g_AdcCapState != ADC_CAP_IDLE)
+      return;
+
+   n = 0;
+   for (i = 0; i < ADC_SCAN_COUNT; i++)
+      if (bit_test(mask, i))
+         n++;
+   if (n == 0)
+      return;
+
+   g_AdcCapMask = mask;
+   g_AdcCapPos = 0;
+   g_AdcCapEnd = (ADC_SCAN_CAP_SIZE / n) * n;   // whole scans only
+   g_AdcCapState = ADC_CAP_ARMED;
+}
+
+void adc_scan_dump_byte(unsigned int8 b)
+{
+   putc(b);
+   g_AdcCapSum += b;
+}
+
+// Send a full capture over the #use rs232 stream, then free the buffer.
+// This takes about a second at 9600 baud, so interrupts stay on between
+// characters; a software UART needs DISABLE_INTS on its #use rs232 to
+// keep them out of each character.
+//    0xA5 0x5A                   sync
+//    mask, bytes per sample      1 byte each
+//    ADC_SCAN_PERIOD_US          2 bytes, low byte first
+//    number of samples           2 bytes, low byte first
+//    samples                     low byte first, the masked entries of
+//                                each scan in list order
+//    check sum                   the bytes after the sync, summed to 8 bits
+void adc_scan_dump(void)
+{
+   unsigned int16 i;
+
+   if (g_AdcCapState != ADC_CAP_FULL)
+      return;
+
+   putc(0xA5);
+   putc(0x5A);
+   g_AdcCapSum = 0;
+   adc_scan_dump_byte(g_AdcCapMask);
+   adc_scan_dump_byte(sizeof(ADC_SCAN_TYPE));
+   adc_scan_dump_byte(make8((unsigned int16)ADC_SCAN_PERIOD_US, 0));
+   adc_scan_dump_byte(make8((unsigned int16)ADC_SCAN_PERIOD_US, 1));
+   adc_scan_dump_byte(make8(g_AdcCapEnd, 0));
+   adc_scan_dump_byte(make8(g_AdcCapEnd, 1));
+
+   for (i = 0; i < g_AdcCapEnd; i++)
+   {
+      adc_scan_dump_byte(make8(g_AdcCap[i], 0));
+      if (sizeof(ADC_SCAN_TYPE) > 1)
+         adc_scan_dump_byte(make8(g_AdcCap[i], 1));
+   }
+   putc(g_AdcCapSum);
+
+   g_AdcCapState = ADC_CAP_IDLE;
+}
+#endif
+
+void adc_scan_init(void)
+{
+  #if defined(ADC_SCAN_FILTERED) && \
+      (defined(ADC_SCAN_BOX_SIZE) || defined(ADC_SCAN_MEDIAN_SIZE))
+   unsigned int8 base;
+  #endif
+
+   for (g_AdcScanIdx = 0; g_AdcScanIdx < ADC_SCAN_COUNT; g_AdcScanIdx++)
+   {
+      g_AdcScanBuf[0].value[g_AdcScanIdx] = 0;
+      g_AdcScanBuf[1].value[g_AdcScanIdx] = 0;
+     #if defined(ADC_SCAN_EVENTS)
+      g_AdcEventRef[g_AdcScanIdx] = 0;
+      g_AdcEventSeq[g_AdcScanIdx] = 0;
+      g_AdcEventSeen[g_AdcScanIdx] = 0;
+     #endif
+   }
+
+   g_AdcScanBuf[0].scan = 0;
+   g_AdcScanBuf[0].time = 0;
+   g_AdcScanSeq = 0;                   // buffer 0 is published, all zero
+   g_AdcScanWr = 1;
+   g_AdcScanCount = 1;
+   g_AdcScanIdx = 0;
+   g_AdcScanBusy = FALSE;
+   g_AdcScanStamp = TRUE;
+
+  #if defined(ADC_SCAN_CAPTURE)
+   g_AdcCapState = ADC_CAP_IDLE;
+  #endif
+
+  #if defined(ADC_SCAN_FILTERED)
+   #if defined(ADC_SCAN_BOX_SIZE)
+   base = 0;                           // rings laid out in list order
+   for (g_AdcScanIdx = 0; g_AdcScanIdx < ADC_SCAN_COUNT; g_AdcScanIdx++)
+   {
+      g_AdcBoxBase[g_AdcScanIdx] = base;
+      g_AdcBoxPos[g_AdcScanIdx] = 0;
+      if ((ADC_SCAN_FILTER[g_AdcScanIdx] & 0x30) == ADC_FILTER_BOX(0))
+         base += (unsigned int16)1 << (ADC_SCAN_FILTER[g_AdcScanIdx] & 0x0F);
+   }
+   g_AdcScanIdx = 0;
+   #endif
+   #if defined(ADC_SCAN_MEDIAN_SIZE)
+   base = 0;                           // histories laid out in list order
+   for (g_AdcScanIdx = 0; g_AdcScanIdx < ADC_SCAN_COUNT; g_AdcScanIdx++)
+   {
+      g_AdcMedBase[g_AdcScanIdx] = base;
+      base += (ADC_SCAN_FILTER[g_AdcScanIdx] >> 5) & 0x06;   // n - 1
+   }
+   g_AdcScanIdx = 0;
+   #endif
+   adc_scan_os_begin(0);
+  #endif
+  #if defined(ADC_SCAN_FILTERED) || defined(ADC_SCAN_EVENTS)
+   g_AdcScanFirst = TRUE;
+  #endif
+
+   set_adc_channel(ADC_SCAN_LIST[0]);
+   clear_interrupt(INT_AD);
+
+  #if defined(ADC_SCAN_FREE_RUN)
+   adc_scan_start();
+  #endif
+}
+
+#endif //ADC_SCAN_COUNT
+
+#endif
@@ -8,16 +8,74 @@
 #define LCD_DATA5      PIN_D5
 #define LCD_DATA6      PIN_D6
 #define LCD_DATA7      PIN_D7
+#define LCD_ROWS       4         // 20x4 module
+#define LCD_BUSY_TIMEOUT          // BUT0-BUT3 modes still run with no LCD fitted
 #include <lcd.c>
+#include <numfmt.c>
+#include <adcscan.c>
+#include <page.h>
+
+/* ================= LCD pages (20x4) ============================
+   One page per mode.  '#' cells are filled in by the mode. */
+#define PAGE_IDLE      0
+#define PAGE_SOUNDER   1
+#define PAGE_KNIGHT    2
+#define PAGE_ADC       3
+#define PAGE_FLASH     4
+#define PAGE_CW        5
+#define PAGE_CCW       6
+
+#define TXT_SOUNDER    0
+#define TXT_KNIGHT     1
+#define TXT_ADC        2
+#define TXT_ADC_ROW    3
+#define TXT_ADC_SUM    4
+#define TXT_FLASH      5
+#define TXT_FLASH_LEDS 6
+#define TXT_CW         7
+#define TXT_CCW        8
+
+const char PAGE_TEXT[9][21] =
+{
+    "Sounder ON",
+    "Knight Rider",
+    "ADC values", " ####  ####  ####", "sum=#####",
+    "Flash dual colour", "LEDs",
+    "Motor Clockwise",
+    "Motor Anti-clockwise"
+};
+
+const PAGE_ITEM PAGE_ITEMS[] =
+{
+    // PAGE_IDLE has no items
+    // PAGE_SOUNDER
+    { 1, 1, 10, TXT_SOUNDER    },
+    // PAGE_KNIGHT
+    { 1, 1, 12, TXT_KNIGHT     },
+    // PAGE_ADC
+    { 1, 1, 10, TXT_ADC        },
+    { 1, 2, 17, TXT_ADC_ROW    },
+    { 1, 3,  9, TXT_ADC_SUM    },
+    // PAGE_FLASH
+    { 1, 1, 17, TXT_FLASH      },
+    { 5, 2,  4, TXT_FLASH_LEDS },
+    // PAGE_CW
+    { 1, 1, 15, TXT_CW         },
+    // PAGE_CCW
+    { 1, 1, 20, TXT_CCW        }
+};
+
+const unsigned int8 PAGE_START[8] = {0, 0, 1, 2, 5, 7, 8, 9};
+
+#include <page.c>
 
 /* ========================= Globals ============================ */
 unsigned int8  buttons        = 0;   // current button mask
 unsigned int8  prev_buttons   = 0;   // previous button mask
 
-unsigned int8  adc0, adc1, adc2;     // AN0, AN1, AN2 latest readings
+unsigned int16 adc0, adc1, adc2;     // AN0, AN1, AN2 latest readings, 10 bit
 
 /* ===================== Prototypes ============================= */
-unsigned int8  read_adc_channel(unsigned int8 chan);
 unsigned int8  read_buttons_mask(void);
 void           reset_outputs(void);
 
@@ -28,16 +86,15 @@ void           mode_dual_bicolor_flash(void);  // BUT3
 void           mode_motor_cw(void);            // BUT0 + BUT1
 void           mode_motor_ccw(void);           // BUT2 + BUT3
 
-unsigned int32 sum_three(unsigned int8 A, unsigned int8 B, unsigned int8 C);
+unsigned int32 sum_three(unsigned int16 A, unsigned int16 B, unsigned int16 C);
 
 /* ============================ MAIN ============================ */
 void main(void)
 {
     setup_adc_ports(sAN0 | sAN1 | sAN2);
-    setup_adc(ADC_CLOCK_INTERNAL | ADC_TAD_MUL_0);
+    adc_setup();
 
-    lcd_init();
-    printf(lcd_putc, "\f");
+    lcd_init();                               // starts out blank, PAGE_IDLE
 
     while (TRUE)
     {
@@ -56,7 +113,7 @@ void main(void)
             case 0x08:  mode_dual_bicolor_flash(); break;  // BUT3
             case 0x03:  mode_motor_cw();           break;  // BUT0 + BUT1
             case 0x0C:  mode_motor_ccw();          break;  // BUT2 + BUT3
-            default: /* idle */                    break;
+            default:    page_show(PAGE_IDLE);      break;  // idle
         }
 
         prev_buttons = buttons;
@@ -72,7 +129,7 @@ void mode_buzzer_on(void)
     output_low (PIN_A7);
 
     if (prev_buttons != buttons) {
-        printf(lcd_putc, "\fSounder ON");
+        page_show(PAGE_SOUNDER);
     }
 }
 
@@ -83,7 +140,7 @@ void mode_knight_rider(void)
         {0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80,0x40,0x20,0x10,0x08,0x04,0x02,0x00};
 
     if (prev_buttons != buttons) {
-        printf(lcd_putc, "\fKnight Rider");
+        page_show(PAGE_KNIGHT);
     }
 
     for (unsigned int8 i = 0; i <= 13; i++) {
@@ -95,28 +152,32 @@ void mode_knight_rider(void)
 // BUT2: show ADC values on LCD and their sum on line 3/4 area
 void mode_show_adc(void)
 {
-    adc0 = read_adc_channel(0);
-    adc1 = read_adc_channel(1);
-    adc2 = read_adc_channel(2);
+    adc0 = adc_read(0);
+    adc1 = adc_read(1);
+    adc2 = adc_read(2);
 
     if (prev_buttons != buttons) {
-        printf(lcd_putc, "\fADC values");
+        page_show(PAGE_ADC);
     }
 
     lcd_gotoxy(1, 2);
-    printf(lcd_putc, "  %3u   %3u   %3u", adc0, adc1, adc2);
+    lcd_putc(" ");
+    fmt_puts(lcd_putc, fmt_u16(adc0, 4));
+    lcd_putc("  ");
+    fmt_puts(lcd_putc, fmt_u16(adc1, 4));
+    lcd_putc("  ");
+    fmt_puts(lcd_putc, fmt_u16(adc2, 4));
 
     lcd_gotoxy(21, 1);  // right side (20x4)
-    printf(lcd_putc, "sum=%5lu", sum_three(adc0, adc1, adc2));
+    lcd_putc("sum=");
+    fmt_puts(lcd_putc, fmt_u32(sum_three(adc0, adc1, adc2), 5));
 }
 
 // BUT3: flash two bi-colour LEDs alternately (E0/E1 and E2/E3)
 void mode_dual_bicolor_flash(void)
 {
     if (prev_buttons != buttons) {
-        printf(lcd_putc, "\fFlash dual colour");
-        lcd_gotoxy(5, 2);
-        printf(lcd_putc, "LEDs");
+        page_show(PAGE_FLASH);
     }
 
     // LED pair 1 (E0/E1)
@@ -138,7 +199,7 @@ void mode_dual_bicolor_flash(void)
 void mode_motor_cw(void)
 {
     if (prev_buttons != buttons) {
-        printf(lcd_putc, "\fMotor Clockwise");
+        page_show(PAGE_CW);
     }
     output_high(PIN_A4);
 }
@@ -147,7 +208,7 @@ void mode_motor_cw(void)
 void mode_motor_ccw(void)
 {
     if (prev_buttons != buttons) {
-        printf(lcd_putc, "\fMotor Anti-clockwise");
+        page_show(PAGE_CCW);
     }
     output_high(PIN_A5);
 }
@@ -162,7 +223,6 @@ void reset_outputs(void)
     output_low(PIN_A4);   // motor CW
     output_low(PIN_A5);   // motor CCW
     output_b(0x00);       // LEDs off
-    printf(lcd_putc, "\f");
 }
 
 // Read buttons: C0..C2 are BUT0..BUT2, D3 is BUT3
@@ -174,16 +234,8 @@ unsigned int8 read_buttons_mask(void)
     return mask;                   // bits: 0..3 correspond to BUT0..BUT3
 }
 
-// Read specified ADC channel (AN0..AN2)
-unsigned int8 read_adc_channel(unsigned int8 chan)
-{
-    set_adc_channel(chan);
-    delay_us(20);
-    return read_adc();             // 0..255 (CCS default 8-bit)
-}
-
-// Sum three bytes safely into 32-bit for printing
-unsigned int32 sum_three(unsigned int8 A, unsigned int8 B, unsigned int8 C)
+// Sum three readings safely into 32-bit for printing
+unsigned int32 sum_three(unsigned int16 A, unsigned int16 B, unsigned int16 C)
 {
     return (unsigned int32)A + (unsigned int32)B + (unsigned int32)C;
 }
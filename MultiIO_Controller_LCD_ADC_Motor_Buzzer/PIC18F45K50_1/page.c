@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+////                            PAGE.C                                     ////
+////             Static screen pages in ROM, switched without a clear      ////
+////                                                                       ////
+////  See page.h for how to describe the pages.                            ////
+////                                                                       ////
+////  Cells are compared straight from the two pages' ROM text, so no RAM  ////
+////  copy of the display is needed.  A switch writes one character per    ////
+////  changed cell plus a set-address command per run of them, about       ////
+////  40 us each, instead of the 1.52 ms clear and a full redraw.          ////
+////                                                                       ////
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PAGE_C__
+#define __PAGE_C__
+
+unsigned int8 g_Page = PAGE_NONE;
+unsigned int8 g_PageX, g_PageY;       // where the next lcd_putc() lands
+
+// Character page n has at x,y, or 0 when none of its items covers the cell
+char page_char(unsigned int8 n, unsigned int8 x, unsigned int8 y)
+{
+   unsigned int8 i, k, t, cell;
+
+   if (n == PAGE_NONE)
+      return 0;
+
+   for (i = PAGE_START[n]; i < PAGE_START[n + 1]; i++)
+   {
+      if ((PAGE_ITEMS[i].y == y) && (x >= PAGE_ITEMS[i].x))
+      {
+         cell = x - PAGE_ITEMS[i].x;
+         if (cell < PAGE_ITEMS[i].width)
+         {
+            t = PAGE_ITEMS[i].text;
+            for (k = 0; k <= cell; k++)    // past the end of the text is blank
+               if (!PAGE_TEXT[t][k])
+                  return ' ';
+            return PAGE_TEXT[t][cell];
+         }
+      }
+   }
+   return 0;
+}
+
+void page_put(unsigned int8 x, unsigned int8 y, char c)
+{
+   if ((x != g_PageX) || (y != g_PageY))
+      lcd_gotoxy(x, y);
+   lcd_putc(c);
+   g_PageX = x + 1;
+   g_PageY = y;
+}
+
+void page_show(unsigned int8 n)
+{
+   unsigned int8 i, x, end;
+   char old, c;
+
+   if (n == g_Page)
+      return;
+
+   g_PageX = 0;                       // the application moved the cursor
+
+   // blank what the old page showed where the new page has nothing
+   if (g_Page != PAGE_NONE)
+   {
+      for (i = PAGE_START[g_Page]; i < PAGE_START[g_Page + 1]; i++)
+      {
+         end = PAGE_ITEMS[i].x + PAGE_ITEMS[i].width;
+         for (x = PAGE_ITEMS[i].x; x < end; x++)
+         {
+            if (page_char(n, x, PAGE_ITEMS[i].y))
+               continue;
+            if (page_char(g_Page, x, PAGE_ITEMS[i].y) != ' ')
+               page_put(x, PAGE_ITEMS[i].y, ' ');
+         }
+      }
+   }
+
+   // write the new page's cells that differ from the old page
+   for (i = PAGE_START[n]; i < PAGE_START[n + 1]; i++)
+   {
+      end = PAGE_ITEMS[i].x + PAGE_ITEMS[i].width;
+      for (x = PAGE_ITEMS[i].x; x < end; x++)
+      {
+         old = page_char(g_Page, x, PAGE_ITEMS[i].y);
+         if (!old)
+            old = ' ';
+         c = page_char(n, x, PAGE_ITEMS[i].y);
+
+         if (c == PAGE_FIELD)
+         {
+            // the application draws it; only clear old static text
+            if ((old != PAGE_FIELD) && (old != ' '))
+               page_put(x, PAGE_ITEMS[i].y, ' ');
+         }
+         else if ((c != old) || (old == PAGE_FIELD))
+            page_put(x, PAGE_ITEMS[i].y, c);
+      }
+   }
+
+   g_Page = n;
+}
+
+#endif
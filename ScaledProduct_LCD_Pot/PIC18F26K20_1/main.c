@@ -8,38 +8,42 @@
 #define LCD_DATA5      PIN_C5
 #define LCD_DATA6      PIN_C6
 #define LCD_DATA7      PIN_C7
+#define LCD_ROWS       4         // 20x4 module
 #include <lcd.c>
+#include <numfmt.c>
+#include <adcscan.c>
 
 /* ======================= Globals ============================
    (Removed unused flags/arrays from earlier versions)
    ============================================================ */
 
 /* ---------- Prototypes ---------- */
-unsigned int8  read_pot_value(void);                  // AN0 ? 0..255
 unsigned int32 compute_scaled_product(
                     unsigned int8 A,
                     unsigned int8 B,
-                    unsigned int8 C);                 // (A*B)*C (32-bit)
+                    unsigned int16 C);                // (A*B)*C (32-bit)
 
 /* ======================== MAIN ============================= */
 void main(void)
 {
     setup_adc_ports(sAN0);                             // Potentiometer on AN0
-    setup_adc(ADC_CLOCK_INTERNAL | ADC_TAD_MUL_0);
+    adc_setup();
 
     lcd_init();
     printf(lcd_putc, "\f");                            // Clear LCD once
 
     while(TRUE)
     {
-        unsigned int8  pot = read_pot_value();
+        unsigned int16 pot = adc_read(0);              // AN0, 0..1023
         unsigned int32 result = compute_scaled_product(16, 15, pot);
 
         lcd_gotoxy(2, 1);
-        printf(lcd_putc, "  result = %5lu", result);
+        lcd_putc("  result = ");
+        fmt_puts(lcd_putc, fmt_u32(result, 6));
 
         lcd_gotoxy(21, 1);
-        printf(lcd_putc, "values 16 15 %3u", pot);
+        lcd_putc("values 16 15 ");
+        fmt_puts(lcd_putc, fmt_u16(pot, 4));
 
         delay_ms(1000);
     }
@@ -47,19 +51,11 @@ void main(void)
 
 /* ===================== Helpers ============================= */
 
-/* Read potentiometer on AN0 (8-bit result by CCS default) */
-unsigned int8 read_pot_value(void)
-{
-    set_adc_channel(0);
-    delay_us(20);                                      // acquisition time
-    return read_adc();                                  // 0..255
-}
-
-/* Multiply three bytes safely into 32-bit to avoid overflow
-   (CCS 'int' is 8-bit; promote before multiply). */
+/* Multiply two bytes and a 10-bit reading safely into 32-bit to
+   avoid overflow (CCS 'int' is 8-bit; promote before multiply). */
 unsigned int32 compute_scaled_product(unsigned int8 A,
                                       unsigned int8 B,
-                                      unsigned int8 C)
+                                      unsigned int16 C)
 {
     unsigned int32 acc = (unsigned int32)A * (unsigned int32)B;
     acc *= (unsigned int32)C;
@@ -22,19 +22,24 @@
 #define LCD_DATA5      PIN_D5
 #define LCD_DATA6      PIN_D6
 #define LCD_DATA7      PIN_D7
+#define LCD_ROWS       4         // 20x4 module
+#define LCD_BUSY_TIMEOUT          // a stuck busy flag cannot hang the RB4-RB7 loop
 
 // -------------------- Library Includes --------------------
 #include <main.h>
 #include <lcd.c>
 
+// -------------------- ADC Channels --------------------
+#define ADC_SCAN_COUNT 3               // AN0..AN2, converted by adc_scan_now()
+const unsigned int8 ADC_SCAN_LIST[ADC_SCAN_COUNT] = {0, 1, 2};
+#include <adcscan.c>
+
 // -------------------- Function Prototypes --------------------
-void analogs(void);
 void printanalogs(void);
 void rotate(void);
 
 // -------------------- Global Variables --------------------
 unsigned int count;
-unsigned int value0, value1, value2;   // ADC readings
 unsigned int lights_A[9] = {0x01, 0x03, 0x04, 0x02, 0x01, 0x01, 0x01, 0x01}; // Sequence for Set A (RA4RA6)
 unsigned int lights_B[9] = {0x01, 0x01, 0x01, 0x01, 0x01, 0x03, 0x04, 0x02}; // Sequence for Set B (RE0RE2)
 
@@ -63,7 +68,8 @@ void EXT2_isr(void) {
 void main() {
    // --- Setup ADC and Timer ---
    setup_adc_ports(AN0_TO_AN2);                     // Enable analog inputs AN0AN2
-   setup_adc(ADC_CLOCK_INTERNAL | ADC_TAD_MUL_0);   // Internal ADC clock
+   adc_setup();                                     // ADC clock from the system clock
+   adc_scan_init();
    setup_timer_2(T2_DIV_BY_16, 249, 15);            // Timer2: 2ms overflow, 30ms interrupt
       
    // --- Enable Interrupts ---
@@ -85,13 +91,13 @@ void main() {
 
       // --- Button RB4: Read and print analog values ---
       if (input(PIN_B4)) {
-         analogs();
+         adc_scan_now();
          printanalogs();
       }
       
       // --- Button RB5: Read analogs and control motor rotation ---
       if (input(PIN_B5)) {
-         analogs();
+         adc_scan_now();
          rotate();
       }
       
@@ -121,20 +127,13 @@ void main() {
    }
 }
 
-// -------------------- Read Analog Inputs --------------------
-void analogs(void) {
-   set_adc_channel(0); delay_us(30); value0 = read_adc();  // AN0
-   set_adc_channel(1); delay_us(30); value1 = read_adc();  // AN1
-   set_adc_channel(2); delay_us(30); value2 = read_adc();  // AN2
-}
-
 // -------------------- Motor Rotation Control --------------------
 void rotate(void) {
-   if (value0 < 120) {                 // Rotate one direction
+   if (adc_scan_value(0) < ADC_FROM8(120)) {       // Rotate one direction
       output_high(PIN_C0);
       output_low(PIN_C1);
    }
-   else if (value0 > 170) {            // Rotate opposite direction
+   else if (adc_scan_value(0) > ADC_FROM8_MAX(170)) {   // Rotate opposite direction
       output_high(PIN_C1);
       output_low(PIN_C0);
    }
@@ -147,11 +146,11 @@ void rotate(void) {
 // -------------------- Print ADC Values to LCD --------------------
 void printanalogs(void) {
    lcd_gotoxy(1, 1);
-   printf(lcd_putc, "Value0 = %3u", value0);
+   printf(lcd_putc, "Value0 = %4lu", adc_scan_value(0));
    
    lcd_gotoxy(1, 2);
-   printf(lcd_putc, "Value1 = %3u", value1);
+   printf(lcd_putc, "Value1 = %4lu", adc_scan_value(1));
    
    lcd_gotoxy(21, 1);
-   printf(lcd_putc, "Value2 = %3u", value2);
+   printf(lcd_putc, "Value2 = %4lu", adc_scan_value(2));
 }
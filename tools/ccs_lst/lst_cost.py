@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Read ROM and cycle figures off a CCS build's Debug.lst / Debug.sym.
+
+    lst_cost.py rom <Debug.sym> <Debug.lst>
+        Size of every routine in the .sym ROM Allocation table, from the
+        gap to the next one (the last ends at "ROM used" in the .lst).
+
+    lst_cost.py cycles <Debug.lst> <start> <end>
+        Instruction words and the fewest/most cycles taken to run from
+        hex address <start> until control leaves [start, end).  Every
+        path is followed; a branch back inside the range is a loop and
+        ends its path, reported so loops can be added by hand.
+
+PIC18 (PCH) listings count addresses in bytes, PIC16 (PCM) in words; the
+header of the .lst says which core it is.
+"""
+import re
+import sys
+
+INSN = re.compile(r'^([0-9A-F]{4,6}):\s+([A-Z]+)\s*(.*?)\s*$')
+
+# PIC18: two-cycle and two-word instructions
+PIC18_TWO_CYCLE = {'BRA', 'RCALL', 'GOTO', 'CALL', 'RETURN', 'RETFIE',
+                   'RETLW', 'MOVFF', 'LFSR', 'TBLRD', 'TBLWT', 'MOVSF'}
+PIC18_COND = {'BZ', 'BNZ', 'BC', 'BNC', 'BN', 'BNN', 'BOV', 'BNOV'}
+SKIPS = {'BTFSC', 'BTFSS', 'CPFSEQ', 'CPFSGT', 'CPFSLT', 'DECFSZ',
+         'INCFSZ', 'DCFSNZ', 'INFSNZ', 'TSTFSZ'}
+PIC16_TWO_CYCLE = {'GOTO', 'CALL', 'RETURN', 'RETLW', 'RETFIE'}
+
+
+def read_lst(path):
+    text = open(path, encoding='latin-1').read()
+    pic18 = 'PCH' in text.splitlines()[0]
+    code = {}
+    for line in text.splitlines():
+        m = INSN.match(line)
+        if m:
+            code[int(m.group(1), 16)] = (m.group(2), m.group(3))
+    return pic18, code, text
+
+
+def target(operand):
+    m = re.match(r'([0-9A-F]+)', operand)
+    return int(m.group(1), 16) if m else None
+
+
+def cycles(path, start, end):
+    pic18, code, _ = read_lst(path)
+    addrs = sorted(a for a in code if start <= a < end)
+    step = {a: b for a, b in zip(addrs, addrs[1:] + [end])}
+    loops = set()
+    totals = []
+
+    def walk(pc, spent, seen):
+        if not (start <= pc < end):
+            totals.append(spent)
+            return
+        if pc in seen:
+            loops.add(pc)
+            totals.append(spent)
+            return
+        seen = seen | {pc}
+        op, arg = code[pc]
+        nxt = step[pc]
+        if op in SKIPS:
+            after = step.get(nxt, end)
+            skip = 2 if not pic18 else (3 if after - nxt == 4 else 2)
+            walk(nxt, spent + 1, seen)
+            walk(after, spent + skip, seen)
+        elif pic18 and op in PIC18_COND:
+            walk(nxt, spent + 1, seen)
+            walk(target(arg), spent + 2, seen)
+        elif op in ('BRA', 'GOTO'):
+            walk(target(arg), spent + 2, seen)
+        elif op in ('RETURN', 'RETLW', 'RETFIE'):
+            totals.append(spent + 2)
+        else:
+            two = PIC18_TWO_CYCLE if pic18 else PIC16_TWO_CYCLE
+            walk(nxt, spent + (2 if op in two else 1), seen)
+
+    walk(start, 0, frozenset())
+    words = sum(2 if pic18 and code[a][0] in ('MOVFF', 'GOTO', 'CALL', 'LFSR')
+                else 1 for a in addrs)
+    print('%s %05X-%05X: %d words, %d-%d cycles%s'
+          % ('PIC18' if pic18 else 'PIC16', start, end, words, min(totals),
+             max(totals),
+             '' if not loops else ', loops at ' +
+             ' '.join('%05X' % a for a in sorted(loops)) + ' not counted'))
+
+
+def rom(sym, lst):
+    _, _, text = read_lst(lst)
+    pic18 = 'PCH' in text.splitlines()[0]
+    used = int(re.search(r'ROM used:\s+(\d+)', text).group(1))
+    table = open(sym, encoding='latin-1').read().split('ROM Allocation:')[1]
+    rows = [(int(a, 16), n) for a, n in
+            re.findall(r'^([0-9A-F]{6})\s+(\S+)', table, re.M)]
+    names = {}
+    for a, n in rows:                  # MAIN shares its address with @cinit1
+        names.setdefault(a, []).append(n)
+    starts = sorted(names)
+    unit = 'bytes' if pic18 else 'words'
+    for a, nxt in zip(starts, starts[1:] + [used]):
+        print('%-24s %5d %s' % ('/'.join(names[a]), nxt - a, unit))
+    print('%-24s %5d %s' % ('ROM used', used, unit))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) == 5 and sys.argv[1] == 'cycles':
+        cycles(sys.argv[2], int(sys.argv[3], 16), int(sys.argv[4], 16))
+    elif len(sys.argv) == 4 and sys.argv[1] == 'rom':
+        rom(sys.argv[2], sys.argv[3])
+    else:
+        sys.exit(__doc__)
@@ -0,0 +1,43 @@
+/* user-011: lcd.c through a serial backpack.  Checks the HD44780 write
+   waveform on the expander outputs and reports bus bytes per character.
+      run.sh backpack.c -DLCD_PCF8574
+      run.sh backpack.c -DLCD_74HC595 -DLCD_595_LATCH_PIN=PIN_B5
+      run.sh backpack.c -DLCD_74HC595 -DLCD_595_LATCH_PIN=PIN_B5 -DLCD_QUEUE */
+#include "expander.c"
+
+static void text(unsigned int8 x, unsigned int8 y, const char *s)
+{
+   lcd_gotoxy(x, y);
+   while (*s)
+      lcd_putc(*s++);
+}
+
+int main(void)
+{
+   long bytes, transactions, data;
+
+   memset(g_Ddram, ' ', sizeof(g_Ddram));
+   lcd_init();
+  #if defined(LCD_QUEUE)
+   while (!lcd_idle())
+      lcd_task();
+  #endif
+   printf("lcd_init(): %ld bus bytes, %s\n", g_BusBytes, g_Bus8 ? "still 8 bit" : "4 bit");
+
+   bytes = g_BusBytes;
+   transactions = g_Transactions;
+   data = g_Data;
+   text(1, 1, "Serial backpack!");
+   text(1, 2, "PCF8574 / 74HC595");
+  #if defined(LCD_QUEUE)
+   while (!lcd_idle())
+      lcd_task();
+  #endif
+   data = g_Data - data;
+   bytes = g_BusBytes - bytes;
+   printf("%ld characters: %ld bus bytes, %ld I2C transactions, %.2f bytes per character\n",
+          data, bytes, g_Transactions - transactions, (double)bytes / data);
+   printf("waveform errors: %d\n", g_Errors);
+   exp_show(2);
+   return g_Errors != 0;
+}
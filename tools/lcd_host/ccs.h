@@ -0,0 +1,46 @@
+/* Just enough of CCS C for gcc to build lcd.c and its friends on the
+   host.  Pin numbers follow the PIC18 headers (port*8 + bit, from
+   PIN_A0 = 31744), which is what lcd.c's contiguous-pin test needs. */
+#include <stdio.h>
+#include <string.h>
+
+#define int1  unsigned char
+#define int8  char
+#define int16 short
+#define int32 int
+#define TRUE  1
+#define FALSE 0
+
+#define PIN_A0 31744
+#define PIN_A6 31750
+#define PIN_A7 31751
+#define PIN_B0 31752
+#define PIN_B1 31753
+#define PIN_B5 31757
+#define PIN_C0 31760
+#define PIN_C1 31761
+#define PIN_C2 31762
+#define PIN_C4 31764
+#define PIN_C5 31765
+#define PIN_C6 31766
+#define PIN_C7 31767
+#define PIN_D0 31768
+#define PIN_D1 31769
+#define PIN_D2 31770
+#define PIN_D4 31772
+#define PIN_D5 31773
+#define PIN_D6 31774
+#define PIN_D7 31775
+
+#define GLOBAL     1
+#define INT_TIMER0 5
+
+void output_bit(int p, int v); int input(int p);
+void output_high(int p); void output_low(int p);
+void output_float(int p); void output_drive(int p);
+void delay_us(long x); void delay_ms(long x); void delay_cycles(int x);
+#define bit_test(v, b)   (((v) >> (b)) & 1)
+#define make8(v, n)      ((unsigned char)((v) >> (8 * (n))))
+void enable_interrupts(int x); void disable_interrupts(int x);
+void i2c_start(void); void i2c_stop(void); int i2c_write(int b);
+void spi_write(int b);
@@ -0,0 +1,46 @@
+/* user-005: where lcd_putc() puts text that runs past the end of a row.
+      run.sh cursor.c                       2 rows, no wrap (the default)
+      run.sh cursor.c -DLCD_ROWS=4
+      run.sh cursor.c -DLCD_ROWS=4 -DLCD_WRAP                           */
+#include "hd44780.c"
+
+static void text(unsigned int8 x, unsigned int8 y, const char *s)
+{
+   lcd_gotoxy(x, y);
+   while (*s)
+      lcd_putc(*s++);
+}
+
+static void show(const char *what)
+{
+   int a, first = -1, last = -1;
+
+   for (a = 0; a < 0x68; a++)
+      if (g_Ddram[a] != ' ')
+      {
+         if (first < 0) first = a;
+         last = a;
+      }
+   printf("   %-34s DDRAM %02X-%02X\n", what, first, last);
+   memset(g_Ddram, ' ', sizeof(g_Ddram));
+}
+
+int main(void)
+{
+   memset(g_Ddram, ' ', sizeof(g_Ddram));
+   lcd_init();
+   printf("LCD_ROWS %d%s\n", LCD_ROWS,
+  #if defined(LCD_WRAP)
+          ", LCD_WRAP"
+  #else
+          ""
+  #endif
+          );
+   text(21, 1, "vals 123 234 345 ");
+   show("gotoxy(21,1), 17 chars");
+   text(15, 1, "0123456789");
+   show("gotoxy(15,1), 10 chars");
+   text(15, 2, "0123456789");
+   show("gotoxy(15,2), 10 chars");
+   return 0;
+}
@@ -0,0 +1,110 @@
+/* HD44780 behind a PCF8574 or 74HC595 backpack, wired as lcd.c expects
+   (RS, RW, E, backlight, D4-D7 from bit 0 up).  Every expander output
+   state is checked against the HD44780 write timing: RW low, and RS and
+   D4-D7 unchanged across the E falling edge, which latches the nibble.
+   Counts bus bytes, I2C transactions and bytes written to DDRAM. */
+int g_pin[65536];
+unsigned char g_Ddram[128];
+int g_Ac, g_Nibble = -1, g_Bus8 = 1, g_Out, g_Errors;
+long g_BusBytes, g_Transactions, g_Data, g_Cmds;
+
+static void exp_outputs(int v)
+{
+   int n, b;
+
+   if ((g_Out & 0x04) && !(v & 0x04))
+   {
+      if ((g_Out & 0xF3) != (v & 0xF3))
+      {
+         printf("   ERROR: RS or data changed with E falling, %02X -> %02X\n", g_Out, v);
+         g_Errors++;
+      }
+      if (v & 0x02)
+      {
+         printf("   ERROR: RW high on a write\n");
+         g_Errors++;
+      }
+      n = v >> 4;
+      if (g_Bus8)                      /* reset: 3, 3, 3, then 2 */
+         g_Bus8 = (n != 2);
+      else if (g_Nibble < 0)
+         g_Nibble = n;
+      else
+      {
+         b = (g_Nibble << 4) | n;
+         g_Nibble = -1;
+         if (v & 0x01)
+         {
+            g_Ddram[g_Ac & 0x7F] = b;
+            g_Data++;
+            if (++g_Ac == 0x28) g_Ac = 0x40;
+            if (g_Ac == 0x68) g_Ac = 0;
+         }
+         else
+         {
+            g_Cmds++;
+            if (b & 0x80) g_Ac = b & 0x7F;
+            if (b == 1) { memset(g_Ddram, ' ', sizeof(g_Ddram)); g_Ac = 0; }
+            if (b == 2) g_Ac = 0;
+         }
+      }
+   }
+   g_Out = v;
+}
+
+/* PCF8574: the first byte after a start is the address, every byte after
+   it appears on the outputs */
+int g_I2cAddress;
+void i2c_start(void) { g_Transactions++; g_I2cAddress = 1; }
+void i2c_stop(void) {}
+int i2c_write(int b)
+{
+   g_BusBytes++;
+   if (g_I2cAddress)
+   {
+      g_I2cAddress = 0;
+     #if defined(LCD_PCF8574)
+      if ((b & 0xFF) != LCD_PCF8574_ADDR)
+      {
+         printf("   ERROR: I2C address %02X\n", b & 0xFF);
+         g_Errors++;
+      }
+     #endif
+   }
+   else
+      exp_outputs(b & 0xFF);
+   return 0;
+}
+
+/* 74HC595: spi_write() fills the shift register, RCLK rising copies it
+   to the outputs */
+int g_Shift;
+void spi_write(int b) { g_BusBytes++; g_Shift = b & 0xFF; }
+
+void output_bit(int p, int v)
+{
+  #if defined(LCD_74HC595)
+   if (p == LCD_595_LATCH_PIN && v && !g_pin[p])
+      exp_outputs(g_Shift);
+  #endif
+   g_pin[p] = v;
+}
+void output_high(int p) { output_bit(p, 1); }
+void output_low(int p)  { output_bit(p, 0); }
+int input(int p) { return 0; }
+void output_float(int p) {}
+void output_drive(int p) {}
+void delay_us(long x) {}
+void delay_ms(long x) {}
+void delay_cycles(int x) {}
+void enable_interrupts(int x) {}
+void disable_interrupts(int x) {}
+
+void exp_show(int rows)
+{
+   static const int base[4] = {0x00, 0x40, 0x14, 0x54};
+   int r;
+
+   for (r = 0; r < rows; r++)
+      printf("   |%.20s|\n", g_Ddram + base[r]);
+}
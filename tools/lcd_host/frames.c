@@ -0,0 +1,64 @@
+/* user-001: bus transfers per frame for ADC5's display, with and without
+   LCD_SHADOW.  Run it both ways:
+      run.sh frames.c
+      run.sh frames.c -DLCD_SHADOW                                      */
+#include "hd44780.c"
+
+static void text(unsigned int8 x, unsigned int8 y, const char *s)
+{
+   lcd_gotoxy(x, y);
+   while (*s)
+      lcd_putc(*s++);
+}
+
+/* ADC5's three lines: the counter on row 2, the five values across the
+   right-hand half of rows 1 and 2 (rows 3 and 4 of a 20x4) */
+static void frame(long counter, const unsigned *v)
+{
+   char b[24];
+
+   sprintf(b, "counter = %4ld ", counter);
+   text(2, 2, b);
+   sprintf(b, "vals %3x %3x %3x ", v[0], v[1], v[2]);
+   text(21, 1, b);
+   sprintf(b, "vals %3x %3x    ", v[3], v[4]);
+   text(21, 2, b);
+  #if defined(LCD_SHADOW)
+   lcd_flush();
+  #endif
+}
+
+int main(void)
+{
+   static const char *what[] =
+   {
+      "first frame", "nothing changed", "counter 0 -> 1",
+      "one value +1", "all five values change", "nothing changed"
+   };
+   unsigned v[5] = {0x123, 0x234, 0x345, 0x356, 0x3FF};
+   long counter = 0, total = 0;
+   int f, i;
+
+   memset(g_Ddram, ' ', sizeof(g_Ddram));
+   lcd_init();
+  #if defined(LCD_SHADOW)
+   printf("LCD_SHADOW\n");
+  #else
+   printf("plain driver\n");
+  #endif
+   printf("   frame                     data  set-addr  other  busy-reads\n");
+   for (f = 0; f < 6; f++)
+   {
+      if (f == 2) counter++;
+      if (f == 3) v[2]++;
+      if (f == 4) for (i = 0; i < 5; i++) v[i] -= 0x101;
+      hd_reset_counts();
+      frame(counter, v);
+      printf("   %-24s %5ld %9ld %6ld %11ld\n", what[f], g_Data, g_SetAddr,
+             g_OtherCmd, g_Reads / 2);
+      total += g_Data + g_SetAddr + g_OtherCmd;
+   }
+   printf("   bytes written over the 6 frames: %ld\n", total);
+   hd_show(4);
+   return 0;
+}
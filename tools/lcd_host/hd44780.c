@@ -0,0 +1,117 @@
+/* HD44780 on ADC5's pins, modelled at the E falling edge.  Counts every
+   bus transfer by kind so the harnesses can report them.  Reads return
+   the address counter (busy flag always clear) or DDRAM.  g_HdBus can
+   take the module away, leaving the data lines pulled up (a hung module
+   that stays busy), pulled down, or floating with the last nibble the
+   PIC drove still on them.  g_Us adds up the delays the driver asked
+   for. */
+#define HD_OK         0
+#define HD_PULLUP     1
+#define HD_PULLDOWN   2
+#define HD_HOLD       3
+
+int g_pin[65536];
+unsigned char g_Ddram[128];
+int g_Ac, g_Nibble = -1, g_ReadLow, g_HdBus = HD_OK, g_Held;
+long g_Data, g_SetAddr, g_OtherCmd, g_Reads, g_Us;
+
+/* E rising with RW high: put the next nibble of the read on the bus */
+static void hd_present(void)
+{
+   int b, n;
+
+   if (g_HdBus == HD_PULLUP)
+      n = 15;
+   else if (g_HdBus == HD_PULLDOWN)
+      n = 0;
+   else if (g_HdBus == HD_HOLD)
+      n = g_Held;
+   else
+   {
+      b = g_pin[LCD_RS_PIN] ? g_Ddram[g_Ac & 0x7F] : (g_Ac & 0x7F);
+      n = g_ReadLow ? (b & 15) : (b >> 4);
+   }
+   lcd_data_port = n << 4;
+}
+
+static void hd_latch(void)
+{
+   int n, b;
+
+   if (g_pin[LCD_RW_PIN])
+   {
+      g_Reads++;                       /* one nibble of a busy/data read */
+      g_ReadLow = !g_ReadLow;
+      if (!g_ReadLow && g_pin[LCD_RS_PIN] && g_HdBus == HD_OK)
+      {
+         if (++g_Ac == 0x28) g_Ac = 0x40;
+         if (g_Ac == 0x68) g_Ac = 0;
+      }
+      return;
+   }
+   n = (lcd_data_lat >> 4) & 15;
+   g_Held = n;
+   if (g_HdBus != HD_OK)
+      return;
+   if (g_Nibble < 0)
+   {
+      g_Nibble = n;
+      return;
+   }
+   b = (g_Nibble << 4) | n;
+   g_Nibble = -1;
+   if (g_pin[LCD_RS_PIN])
+   {
+      g_Ddram[g_Ac & 0x7F] = b;
+      g_Data++;
+      if (++g_Ac == 0x28) g_Ac = 0x40;
+      if (g_Ac == 0x68) g_Ac = 0;
+   }
+   else if (b & 0x80)
+   {
+      g_Ac = b & 0x7F;
+      g_SetAddr++;
+   }
+   else
+   {
+      g_OtherCmd++;
+      if (b == 1) { memset(g_Ddram, ' ', sizeof(g_Ddram)); g_Ac = 0; }
+      if (b == 2) g_Ac = 0;
+   }
+}
+
+void output_bit(int p, int v)
+{
+   if (p == LCD_ENABLE_PIN && v && !g_pin[p] && g_pin[LCD_RW_PIN])
+      hd_present();
+   if (p == LCD_ENABLE_PIN && !v && g_pin[p])
+      hd_latch();
+   g_pin[p] = v;
+}
+void output_high(int p) { output_bit(p, 1); }
+void output_low(int p)  { output_bit(p, 0); }
+int input(int p) { return 0; }
+void output_float(int p) {}
+void output_drive(int p) {}
+void delay_us(long x) { g_Us += x; }
+void delay_ms(long x) { g_Us += 1000 * x; }
+void delay_cycles(int x) {}
+void enable_interrupts(int x) {}
+void disable_interrupts(int x) {}
+
+/* the reset nibbles are sent one at a time, resynchronise after init */
+void hd_reset_counts(void)
+{
+   g_Nibble = -1;
+   g_ReadLow = 0;
+   g_Data = g_SetAddr = g_OtherCmd = g_Reads = 0;
+}
+
+void hd_show(int rows)
+{
+   static const int base[4] = {0x00, 0x40, 0x14, 0x54};
+   int r;
+
+   for (r = 0; r < rows; r++)
+      printf("   |%.20s|\n", g_Ddram + base[r]);
+}
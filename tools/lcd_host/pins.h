@@ -0,0 +1,8 @@
+/* ADC5's wiring: RS, RW, E on C0-C2, D4-D7 on C4-C7 (contiguous) */
+#define LCD_ENABLE_PIN PIN_C2
+#define LCD_RS_PIN     PIN_C0
+#define LCD_RW_PIN     PIN_C1
+#define LCD_DATA4      PIN_C4
+#define LCD_DATA5      PIN_C5
+#define LCD_DATA6      PIN_C6
+#define LCD_DATA7      PIN_C7
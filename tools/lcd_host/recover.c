@@ -0,0 +1,78 @@
+/* user-017: what lcd_putc() does once LCD_BUSY_TIMEOUT has marked the LCD
+   faulted, for each way the data lines can look with no module answering,
+   and how long the slowest lcd_putc() call took (delays only, with the
+   queue drained between characters).
+      run.sh recover.c -DLCD_BUSY_TIMEOUT
+      run.sh recover.c -DLCD_BUSY_TIMEOUT -DLCD_QUEUE
+      run.sh recover.c -DLCD_BUSY_TIMEOUT -DLCD_QUEUE -DLCD_INIT_ASYNC
+      run.sh recover.c -DLCD_BUSY_TIMEOUT -DLCD_MINIMAL                 */
+#include "hd44780.c"
+
+long g_Slowest;
+
+static void put(char c)
+{
+   long us = g_Us;
+
+   lcd_putc(c);
+   if (g_Us - us > g_Slowest)
+      g_Slowest = g_Us - us;
+  #if defined(LCD_QUEUE)
+   while (!lcd_idle())                 /* the tick's share, not timed */
+      lcd_task_sync();
+  #endif
+}
+
+/* 600 characters with the bus in the given state, counting the times the
+   LCD was re-initialised (every lcd_init() waits 15ms first) */
+static void run(const char *what, int bus)
+{
+   long inits = 0, us;
+   int i;
+
+   g_HdBus = bus;
+   g_Slowest = 0;
+   for (i = 0; i < 600; i++)
+   {
+      us = g_Us;
+      put('a' + i % 26);
+      if (g_Us - us >= 15000)
+         inits++;
+   }
+   printf("   %-26s fault %d, re-inits %ld, slowest lcd_putc %ld us\n",
+          what, (int)lcd_fault(), inits, g_Slowest);
+}
+
+int main(void)
+{
+   int i;
+
+   memset(g_Ddram, ' ', sizeof(g_Ddram));
+   lcd_init();
+  #if defined(LCD_QUEUE)
+   while (!lcd_idle())
+      lcd_task_sync();
+  #endif
+   hd_reset_counts();
+
+   g_HdBus = HD_PULLUP;                /* hung module, busy for ever */
+   for (i = 0; i < 20 && !lcd_fault(); i++)
+      put('x');
+   printf("busy flag stuck: faulted after %d characters\n", i);
+
+   run("data lines pulled up", HD_PULLUP);
+   run("data lines pulled down", HD_PULLDOWN);
+   run("floating, last nibble held", HD_HOLD);
+
+   g_HdBus = HD_OK;
+   g_Slowest = 0;
+   for (i = 0; i < 600 && lcd_fault(); i++)
+      put('y');
+   printf("module back: recovered after %d characters, fault %d, that lcd_putc %ld us\n",
+          i, (int)lcd_fault(), g_Slowest);
+   lcd_gotoxy(1, 1);
+   for (i = 0; i < 8; i++)
+      put("answers!"[i]);
+   hd_show(2);
+   return 0;
+}
@@ -0,0 +1,20 @@
+#!/bin/sh
+# Host harnesses for lcd.c, see README.md.
+#    run.sh <harness.c> [-DOPTION ...]
+# lcd.c is taken from ADC5 (every project carries the same copy) unless
+# LCD_C names another.  CCS directives gcc cannot parse are commented out.
+here=$(cd "$(dirname "$0")" && pwd)
+lcd=${LCD_C:-$here/../../ADC5_Timer_LCD_Counter/PIC18F26K20_1/lcd.c}
+harness=$1; shift
+out=${TMPDIR:-/tmp}/lcd_host_$$
+{
+   printf '#include "%s/ccs.h"\n' "$here"
+   for d in "$@"; do echo "$d" | sed -E 's/^-D([^=]*)(=(.*))?$/#define \1 \3/'; done
+   cat "$here/pins.h"
+   sed -E 's/^[[:space:]]*#(byte|use|inline|separate)/\/\/&/' "$lcd" "$here/$harness"
+} > "$out.c"
+gcc -std=gnu99 -I"$here" -Wall -Wno-unused -Wno-parentheses -Wno-main -Wno-char-subscripts \
+    -o "$out" "$out.c" && "$out"
+status=$?
+rm -f "$out" "$out.c"
+exit $status